@@ -0,0 +1,67 @@
+#include "Adler32.h"
+
+/**
+ * @file Adler32.cpp
+ * @brief Implementation of the Adler-32 checksum
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const uint32_t ADLER_MOD = 65521;
+
+// Largest n such that 255n(n+1)/2 + (n+1)(ADLER_MOD-1) fits in 32 bits,
+// i.e. how many bytes can be summed before a modulo is required.
+const size_t ADLER_NMAX = 5552;
+
+} // namespace
+
+uint32_t Adler32::update(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+
+    while (size > 0) {
+        size_t n = size < ADLER_NMAX ? size : ADLER_NMAX;
+        size -= n;
+
+        while (n >= 8) {
+            a += data[0]; b += a;
+            a += data[1]; b += a;
+            a += data[2]; b += a;
+            a += data[3]; b += a;
+            a += data[4]; b += a;
+            a += data[5]; b += a;
+            a += data[6]; b += a;
+            a += data[7]; b += a;
+            data += 8;
+            n -= 8;
+        }
+        while (n > 0) {
+            a += *data++;
+            b += a;
+            n--;
+        }
+
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+
+    return (b << 16) | a;
+}
+
+uint32_t Adler32::combine(uint32_t first, uint32_t second, uint64_t secondSize) {
+    // Appending n bytes adds n * a1 to b and shifts both sums by the second
+    // block's own sums; the second checksum started from a = 1, b = 0, so
+    // one is taken back off a and n off b.
+    uint32_t remainder = static_cast<uint32_t>(secondSize % ADLER_MOD);
+    uint32_t a = first & 0xFFFF;
+    uint32_t b = static_cast<uint32_t>((static_cast<uint64_t>(remainder) * a) % ADLER_MOD);
+    a += (second & 0xFFFF) + ADLER_MOD - 1;
+    b += (first >> 16) + (second >> 16) + ADLER_MOD - remainder;
+    if (a >= ADLER_MOD) a -= ADLER_MOD;
+    if (a >= ADLER_MOD) a -= ADLER_MOD;
+    if (b >= 2 * ADLER_MOD) b -= 2 * ADLER_MOD;
+    if (b >= ADLER_MOD) b -= ADLER_MOD;
+    return (b << 16) | a;
+}
@@ -0,0 +1,35 @@
+#ifndef ADLER32_H
+#define ADLER32_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file Adler32.h
+ * @brief Adler-32 checksum used by the zlib stream framing
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+class Adler32 {
+public:
+    /**
+     * @brief Continues an Adler-32 checksum over a block of bytes
+     * @param adler Running checksum (1 for a fresh stream)
+     * @param data Pointer to the bytes
+     * @param size Number of bytes
+     * @return Updated checksum
+     */
+    static uint32_t update(uint32_t adler, const uint8_t* data, size_t size);
+
+    /**
+     * @brief Combines the checksums of two consecutive blocks without their bytes
+     * @param first Checksum of the first block (started from 1)
+     * @param second Checksum of the second block (started from 1)
+     * @param secondSize Number of bytes in the second block
+     * @return Checksum of the two blocks concatenated
+     */
+    static uint32_t combine(uint32_t first, uint32_t second, uint64_t secondSize);
+};
+
+#endif // ADLER32_H
@@ -0,0 +1,194 @@
+#include "BatchProcessor.h"
+#include "BufferPool.h"
+#include "Pipeline.h"
+#include "RandomAccessFile.h"
+#include "Stats.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * @file BatchProcessor.cpp
+ * @brief Implementation of BatchProcessor class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Everything one file carries between stages. Only the stage currently
+// holding the job touches it. The pipeline admits job i + depth only after
+// job i has left the sink, so depth slots serve any number of files.
+struct Job {
+    std::vector<uint8_t> file;
+    PNGImage image;
+    std::stringstream encoded;
+    Clock::time_point start;
+    BatchResult result;
+};
+
+// Prints an error of the batch itself and keeps it as the reason the file failed.
+bool fail(std::string& error, const std::string& message) {
+    std::cout << "Error: " << message << std::endl;
+    error = message;
+    return false;
+}
+
+bool readWholeFile(const std::string& filename, std::vector<uint8_t>& bytes, std::string& error) {
+    ScopedTimer timer(Stage::FILE_READ);
+    RandomAccessFile file;
+    if (!file.open(filename)) {
+        return fail(error, "Cannot open file " + filename);
+    }
+    bytes = BufferPool::shared().acquire(static_cast<size_t>(file.size()));
+    if (!file.readAt(0, bytes.data(), bytes.size())) {
+        return fail(error, "Cannot read file " + filename);
+    }
+    timer.setBytes(bytes.size(), bytes.size());
+    return true;
+}
+
+// Runs one stage of one file; the stage records in error why it failed,
+// and fallback stands in if it left no reason. A file too large for memory
+// or otherwise throwing fails on its own; an exception reaching a pipeline
+// thread would end the whole batch.
+template <typename Work>
+bool isolate(const std::string& filename, const char* fallback, std::string& error, Work work) {
+    bool ok = false;
+    try {
+        ok = work();
+    } catch (const std::bad_alloc&) {
+        fail(error, "Out of memory while processing " + filename);
+    } catch (const std::exception& e) {
+        fail(error, e.what() + std::string(" while processing ") + filename);
+    }
+    if (!ok && error.empty()) {
+        error = fallback;
+    }
+    return ok;
+}
+
+} // namespace
+
+BatchProcessor::BatchProcessor(const ImageCompressor& compressor)
+    : compressor(compressor), readers(2), depth(Pipeline::DEFAULT_DEPTH), pngLevel(6) {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    decoders = std::max<size_t>(1, cores / 2);
+    encoders = std::max<size_t>(1, cores / 2);
+}
+
+bool BatchProcessor::run(BatchMode mode, const std::vector<std::string>& inputs,
+                         const std::vector<std::string>& outputs, const Report& report) {
+    if (inputs.size() != outputs.size()) {
+        std::cout << "Error: Every input needs exactly one output" << std::endl;
+        return false;
+    }
+
+    Pipeline pipeline(depth);
+    std::vector<Job> jobs(std::max<size_t>(1, std::min(pipeline.getDepth(), inputs.size())));
+
+    pipeline.addStage(readers, [&](size_t i) {
+        Job& job = jobs[i % jobs.size()];
+        BatchResult result = {inputs[i], outputs[i], false, std::string(), 0, 0, 0, 0.0};
+        job.result = result;
+        job.start = Clock::now();
+        return isolate(inputs[i], "Cannot read file", job.result.error, [&]() {
+            if (!readWholeFile(inputs[i], job.file, job.result.error)) {
+                return false;
+            }
+            job.result.inputBytes = job.file.size();
+            return true;
+        });
+    });
+
+    pipeline.addStage(decoders, [&](size_t i) {
+        Job& job = jobs[i % jobs.size()];
+        return isolate(inputs[i], "Cannot decode file", job.result.error, [&]() {
+            ByteSpan bytes = {job.file.data(), job.file.size()};
+            bool ok;
+            if (mode == BatchMode::COMPRESS) {
+                ok = job.image.decodePNG(bytes);
+                if (!ok) {
+                    job.result.error = job.image.getError();
+                }
+            } else {
+                // Version 1 files are only read through their own parser.
+                ImageCompressor decoder = compressor;
+                ok = SametHeader::hasMagic(bytes.data, bytes.size) ? decoder.loadCompressed(bytes, job.image)
+                                                                   : decoder.loadCompressed(inputs[i], job.image);
+                if (!ok) {
+                    job.result.error = decoder.getError();
+                }
+            }
+            BufferPool::shared().release(job.file);
+            job.result.rawBytes = job.image.getData().size();
+            return ok;
+        });
+    });
+
+    pipeline.addStage(encoders, [&](size_t i) {
+        Job& job = jobs[i % jobs.size()];
+        return isolate(inputs[i], "Cannot encode image", job.result.error, [&]() {
+            bool ok;
+            if (mode == BatchMode::COMPRESS) {
+                ImageCompressor encoder = compressor;
+                ok = encoder.writeCompressed(job.image.getPixels(), job.image.getWidth(), job.image.getHeight(),
+                                             job.image.getChannels(), job.image.getBitDepth(), job.encoded);
+                if (!ok) {
+                    job.result.error = encoder.getError();
+                }
+            } else {
+                ok = job.image.writePNG(job.encoded, job.image.getPixels(), job.image.getWidth(),
+                                        job.image.getHeight(), job.image.getChannels(), pngLevel);
+                if (!ok) {
+                    job.result.error = job.image.getError();
+                }
+            }
+            std::vector<uint8_t> pixels = job.image.takeData();
+            BufferPool::shared().release(pixels);
+            return ok;
+        });
+    });
+
+    bool converted = pipeline.run(inputs.size(), [&](size_t i, bool ok) {
+        Job& job = jobs[i % jobs.size()];
+        BatchResult& result = job.result;
+        if (ok) {
+            ok = isolate(inputs[i], "Cannot write file", result.error, [&]() {
+                ScopedTimer timer(Stage::FILE_WRITE);
+                std::ofstream out(outputs[i], std::ios::binary);
+                out << job.encoded.rdbuf();
+                std::streamoff written = out.tellp();
+                out.close();
+                if (out.fail()) {
+                    return fail(result.error, "Cannot write file " + outputs[i]);
+                }
+                result.outputBytes = static_cast<uint64_t>(written);
+                timer.setBytes(result.outputBytes, result.outputBytes);
+                return true;
+            });
+        }
+        // Whatever a failed job left behind goes back before the slot is reused.
+        std::stringstream().swap(job.encoded);
+        BufferPool::shared().release(job.file);
+        std::vector<uint8_t> pixels = job.image.takeData();
+        BufferPool::shared().release(pixels);
+
+        result.ok = ok;
+        Stats::add(ok ? Counter::FILES_OK : Counter::FILES_FAILED);
+        result.seconds = std::chrono::duration<double>(Clock::now() - job.start).count();
+        if (report) {
+            report(result);
+        }
+        return ok;
+    });
+
+    return converted;
+}
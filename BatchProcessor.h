@@ -0,0 +1,93 @@
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ImageCompressor.h"
+
+/**
+ * @file BatchProcessor.h
+ * @brief Contains BatchProcessor class for converting many files at once
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Direction of a batch conversion
+ */
+enum class BatchMode {
+    COMPRESS,   // .png to .samet
+    DECOMPRESS  // .samet to .png
+};
+
+/**
+ * @brief Outcome of converting one file
+ */
+struct BatchResult {
+    std::string input;
+    std::string output;
+    bool ok;
+    std::string error;      // why the file failed, empty when ok
+    uint64_t inputBytes;    // size of the input file
+    uint64_t rawBytes;      // size of the decoded pixels
+    uint64_t outputBytes;   // size of the written file
+    double seconds;         // from admission into the pipeline until written
+};
+
+/**
+ * @brief Converts files through a read, decode, encode and write pipeline
+ *
+ * Reading, decoding and encoding run on their own threads with a bounded
+ * number of files in flight, so the disk and the CPU stay busy at the same
+ * time. Files are written and reported in input order from the calling
+ * thread. Decoding and encoding still spread each image over the thread
+ * pool, so large images do not hold up a stage on their own.
+ */
+class BatchProcessor {
+public:
+    typedef std::function<void(const BatchResult&)> Report;
+
+    /**
+     * @brief Constructor
+     * @param compressor Compressor whose settings are used for every file
+     */
+    explicit BatchProcessor(const ImageCompressor& compressor);
+
+    void setReaderThreads(size_t threads) { readers = threads; }
+    void setDecoderThreads(size_t threads) { decoders = threads; }
+    void setEncoderThreads(size_t threads) { encoders = threads; }
+
+    /**
+     * @brief Sets how many files may be in flight at once, bounding memory use
+     */
+    void setDepth(size_t files) { depth = files; }
+
+    /**
+     * @brief Sets the deflate effort of PNG files written when decompressing
+     */
+    void setPNGCompressionLevel(int level) { pngLevel = level; }
+
+    /**
+     * @brief Converts every input into the output at the same position
+     * @param mode Conversion direction
+     * @param inputs Input file paths
+     * @param outputs Output file paths, written exactly as given
+     * @param report Callback receiving each result in input order, may be empty
+     * @return true if every file was converted, false otherwise
+     */
+    bool run(BatchMode mode, const std::vector<std::string>& inputs,
+             const std::vector<std::string>& outputs, const Report& report);
+
+private:
+    ImageCompressor compressor;
+    size_t readers;
+    size_t decoders;
+    size_t encoders;
+    size_t depth;
+    int pngLevel;
+};
+
+#endif // BATCH_PROCESSOR_H
@@ -0,0 +1,147 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/**
+ * @file BoundedQueue.h
+ * @brief Contains BoundedQueue class, a fixed-capacity lock-free queue
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Lock-free multi-producer multi-consumer ring buffer
+ *
+ * Every cell carries a sequence number telling producers and consumers whose
+ * turn it is, so a push or pop is one compare-and-swap on the shared position
+ * plus one store to the cell. The blocking push() and pop() back off from
+ * spinning to yielding to short sleeps, which suits stages whose work items
+ * take milliseconds rather than nanoseconds.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Minimum number of items held, rounded up to a power of two
+     */
+    explicit BoundedQueue(size_t capacity) : enqueuePos(0), dequeuePos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Appends an item unless the queue is full
+     * @return true if the item was queued
+     */
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Takes the oldest item unless the queue is empty
+     * @return true if an item was taken
+     */
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Appends an item, waiting while the queue is full
+     */
+    void push(const T& value) {
+        for (unsigned attempt = 0; !tryPush(value); attempt++) {
+            backoff(attempt);
+        }
+    }
+
+    /**
+     * @brief Takes the oldest item, waiting while the queue is empty
+     */
+    T pop() {
+        T value;
+        for (unsigned attempt = 0; !tryPop(value); attempt++) {
+            backoff(attempt);
+        }
+        return value;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static void backoff(unsigned attempt) {
+        if (attempt < 32) {
+            return;
+        }
+        if (attempt < 64) {
+            std::this_thread::yield();
+            return;
+        }
+        // Sleep 50 us at first, doubling up to 1.6 ms while the wait goes on.
+        unsigned shift = attempt - 64 < 5 ? attempt - 64 : 5;
+        std::this_thread::sleep_for(std::chrono::microseconds(50u << shift));
+    }
+
+    // Producers and consumers each hammer their own position; the padding
+    // keeps the two off one cache line without needing aligned allocation.
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    std::atomic<size_t> enqueuePos;
+    char padding[64];
+    std::atomic<size_t> dequeuePos;
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,116 @@
+#include "BufferPool.h"
+#include <utility>
+
+/**
+ * @file BufferPool.cpp
+ * @brief Implementation of BufferPool class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+const size_t BufferPool::MIN_SIZE;
+const size_t BufferPool::DEFAULT_LIMIT;
+const size_t BufferPool::CLASS_COUNT;
+
+namespace {
+
+// Index of the highest set bit; capacities are filed under this class.
+inline size_t floorLog2(size_t value) {
+    size_t bits = 0;
+    while (value >>= 1) {
+        bits++;
+    }
+    return bits;
+}
+
+// Smallest class whose every buffer can hold size bytes.
+inline size_t ceilLog2(size_t value) {
+    size_t bits = floorLog2(value);
+    return (static_cast<size_t>(1) << bits) < value ? bits + 1 : bits;
+}
+
+} // namespace
+
+BufferPool::BufferPool(size_t limit) : limit(limit), cached(0) {}
+
+BufferPool& BufferPool::shared() {
+    static BufferPool pool;
+    return pool;
+}
+
+std::vector<uint8_t> BufferPool::acquire(size_t size) {
+    std::vector<uint8_t> buffer;
+    if (size < MIN_SIZE) {
+        buffer.resize(size);
+        return buffer;
+    }
+
+    // Only the exact class and the one above are searched, so a small request
+    // never ties up a buffer that a full-size image is waiting for.
+    size_t first = ceilLog2(size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t c = first; c < CLASS_COUNT && c <= first + 1; c++) {
+            if (!classes[c].empty()) {
+                buffer.swap(classes[c].back());
+                classes[c].pop_back();
+                cached -= buffer.capacity();
+                break;
+            }
+        }
+    }
+
+    // New buffers are rounded up to their class so they can serve any request
+    // of that class once released. Only the bytes resized below are touched.
+    if (buffer.capacity() == 0 && first < CLASS_COUNT - 1) {
+        buffer.reserve(static_cast<size_t>(1) << first);
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+void BufferPool::release(std::vector<uint8_t>& buffer) {
+    std::vector<uint8_t> taken;
+    taken.swap(buffer);
+    size_t capacity = taken.capacity();
+    if (capacity < MIN_SIZE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capacity > limit - cached) {
+        return;
+    }
+    classes[floorLog2(capacity)].push_back(std::move(taken));
+    cached += capacity;
+}
+
+void BufferPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t c = 0; c < CLASS_COUNT; c++) {
+        classes[c].clear();
+    }
+    cached = 0;
+}
+
+void BufferPool::setLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = bytes;
+    // Shrink from the largest buffers down until the cache fits again.
+    for (size_t c = CLASS_COUNT; c-- > 0 && cached > limit;) {
+        while (!classes[c].empty() && cached > limit) {
+            cached -= classes[c].back().capacity();
+            classes[c].pop_back();
+        }
+    }
+}
+
+size_t BufferPool::getLimit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limit;
+}
+
+size_t BufferPool::getCachedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cached;
+}
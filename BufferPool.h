@@ -0,0 +1,80 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file BufferPool.h
+ * @brief Contains BufferPool class for recycling large byte buffers
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Size-classed cache of byte buffers shared across images
+ *
+ * Buffers are grouped by power-of-two capacity. acquire() hands out a cached
+ * buffer whose capacity covers the request, so a long run over similar images
+ * keeps reusing the same few allocations instead of returning them to the
+ * allocator after every file. Buffers below MIN_SIZE are not worth caching and
+ * go straight to the allocator.
+ */
+class BufferPool {
+public:
+    static const size_t MIN_SIZE = 4 * 1024;
+    static const size_t DEFAULT_LIMIT = 256 * 1024 * 1024;
+
+    /**
+     * @brief Constructor
+     * @param limit Maximum number of bytes kept cached
+     */
+    explicit BufferPool(size_t limit = DEFAULT_LIMIT);
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief Returns the process-wide pool
+     */
+    static BufferPool& shared();
+
+    /**
+     * @brief Hands out a buffer of the given size
+     *
+     * The contents are unspecified; callers are expected to overwrite them.
+     * @param size Number of bytes
+     * @return Buffer with size() == size
+     */
+    std::vector<uint8_t> acquire(size_t size);
+
+    /**
+     * @brief Takes a buffer back for reuse, leaving the argument empty
+     *
+     * The buffer is dropped instead when it is too small to cache or the pool
+     * already holds its limit.
+     * @param buffer Buffer to recycle
+     */
+    void release(std::vector<uint8_t>& buffer);
+
+    /**
+     * @brief Frees every cached buffer
+     */
+    void clear();
+
+    void setLimit(size_t bytes);
+    size_t getLimit() const;
+    size_t getCachedBytes() const;
+
+private:
+    static const size_t CLASS_COUNT = sizeof(size_t) * 8;
+
+    mutable std::mutex mutex;
+    std::vector<std::vector<uint8_t> > classes[CLASS_COUNT];
+    size_t limit;
+    size_t cached;
+};
+
+#endif // BUFFER_POOL_H
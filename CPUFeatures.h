@@ -0,0 +1,52 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * @file CPUFeatures.h
+ * @brief Runtime detection of the SIMD extensions used by the optimized kernels
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+// SIMD kernels are compiled per function with target attributes so the
+// baseline build flags stay portable; dispatch happens at runtime.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_X86_SIMD 1
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+struct CPUFeatures {
+    bool sse2;
+    bool ssse3;
+    bool sse41;
+    bool pclmul;
+    bool avx2;
+
+    /**
+     * @brief Returns the features of the running CPU, detected on first use
+     */
+    static const CPUFeatures& get() {
+        static const CPUFeatures features = detect();
+        return features;
+    }
+
+private:
+    static CPUFeatures detect() {
+        CPUFeatures features = {false, false, false, false, false};
+#ifdef CPU_X86_SIMD
+        __builtin_cpu_init();
+        features.sse2 = __builtin_cpu_supports("sse2");
+        features.ssse3 = __builtin_cpu_supports("ssse3");
+        features.sse41 = __builtin_cpu_supports("sse4.1");
+        features.pclmul = __builtin_cpu_supports("pclmul");
+        features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return features;
+    }
+};
+
+#endif // CPU_FEATURES_H
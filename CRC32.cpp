@@ -0,0 +1,184 @@
+#include "CRC32.h"
+#include "CPUFeatures.h"
+#include <cstring>
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * @file CRC32.cpp
+ * @brief Implementation of the CRC32 class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const uint32_t CRC_POLYNOMIAL = 0xEDB88320;  // reflected 0x04C11DB7
+
+struct CRCTables {
+    uint32_t table[8][256];
+};
+
+// table[0] is the classic byte-at-a-time table; table[k][i] is the CRC of
+// byte i followed by k zero bytes, which lets eight bytes be folded at once.
+constexpr CRCTables makeTables() {
+    CRCTables tables = {};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC_POLYNOMIAL : crc >> 1;
+        }
+        tables.table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t previous = tables.table[k - 1][i];
+            tables.table[k][i] = (previous >> 8) ^ tables.table[0][previous & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr CRCTables CRC_TABLES = makeTables();
+
+inline uint32_t load32LE(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+#else
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+#endif
+}
+
+// Works on the inverted CRC register.
+uint32_t updateSliceBy8(uint32_t crc, const uint8_t* data, size_t size) {
+    const uint32_t (*t)[256] = CRC_TABLES.table;
+
+    while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        size--;
+    }
+    while (size >= 8) {
+        uint32_t one = load32LE(data) ^ crc;
+        uint32_t two = load32LE(data + 4);
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+              t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+              t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+              t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        size--;
+    }
+    return crc;
+}
+
+#ifdef CPU_X86_SIMD
+
+const size_t PCLMUL_MIN_SIZE = 64;
+
+/**
+ * Folds 64-byte blocks with carry-less multiplication and reduces the
+ * remaining 128 bits with a Barrett reduction (Intel, "Fast CRC Computation
+ * for Generic Polynomials Using PCLMULQDQ"). Requires size >= 64 and a
+ * multiple of 16; works on the inverted CRC register.
+ */
+TARGET_PCLMUL
+uint32_t updatePclmul(uint32_t crc, const uint8_t* data, size_t size) {
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124LL);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    data += 64;
+    size -= 64;
+
+    while (size >= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)));
+        data += 64;
+        size -= 64;
+    }
+
+    // Fold the four lanes into one.
+    __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (size >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+        data += 16;
+        size -= 16;
+    }
+
+    // 128 -> 64 bits.
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits.
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif // CPU_X86_SIMD
+
+const bool HAVE_PCLMUL = CPUFeatures::get().pclmul && CPUFeatures::get().sse41;
+
+} // namespace
+
+uint32_t CRC32::update(uint32_t crc, const uint8_t* data, size_t size) {
+    crc = ~crc;
+#ifdef CPU_X86_SIMD
+    if (HAVE_PCLMUL && size >= PCLMUL_MIN_SIZE) {
+        size_t folded = size & ~static_cast<size_t>(15);
+        crc = updatePclmul(crc, data, folded);
+        data += folded;
+        size -= folded;
+    }
+#endif
+    crc = updateSliceBy8(crc, data, size);
+    return ~crc;
+}
+
+bool CRC32::usesCarrylessMultiply() {
+    return HAVE_PCLMUL;
+}
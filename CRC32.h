@@ -0,0 +1,38 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file CRC32.h
+ * @brief CRC-32 (ISO 3309 / PNG) checksum engine
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Incremental CRC-32 as used by PNG chunks
+ *
+ * Buffers are processed with a slice-by-8 table walk, or by carry-less
+ * multiplication folding (PCLMULQDQ) when the CPU supports it. The
+ * implementation is picked once at startup.
+ */
+class CRC32 {
+public:
+    /**
+     * @brief Continues a CRC over a block of bytes
+     * @param crc CRC of the bytes seen so far (0 for a fresh checksum)
+     * @param data Pointer to the bytes
+     * @param size Number of bytes
+     * @return CRC of all bytes seen, ready to be stored or passed back in
+     */
+    static uint32_t update(uint32_t crc, const uint8_t* data, size_t size);
+
+    /**
+     * @brief Reports whether the carry-less multiplication path is in use
+     */
+    static bool usesCarrylessMultiply();
+};
+
+#endif // CRC32_H
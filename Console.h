@@ -0,0 +1,24 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <iostream>
+
+/**
+ * @file Console.h
+ * @brief Contains the CONSOLE_INFO macro for informational messages of the library
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * Prints a progress or summary message, e.g. CONSOLE_INFO("Width: " << width << std::endl).
+ * Building with -DIMAGE_COMPRESSOR_QUIET (make QUIET=1) compiles the messages
+ * out entirely; error messages are printed either way.
+ */
+#ifdef IMAGE_COMPRESSOR_QUIET
+#define CONSOLE_INFO(message) do { } while (0)
+#else
+#define CONSOLE_INFO(message) do { std::cout << message; } while (0)
+#endif
+
+#endif // CONSOLE_H
@@ -0,0 +1,656 @@
+#include "Deflater.h"
+#include "Adler32.h"
+#include "HuffmanCoder.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @file Deflater.cpp
+ * @brief Implementation of the Deflater class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const size_t WINDOW_SIZE = 32768;
+const size_t WINDOW_MASK = WINDOW_SIZE - 1;
+const unsigned HASH_BITS = 15;
+const size_t HASH_SIZE = static_cast<size_t>(1) << HASH_BITS;
+const unsigned MIN_MATCH = 4;       // matches are found through a 4-byte hash
+const unsigned MAX_MATCH = 258;
+const size_t MAX_STORED_BLOCK = 65535;
+const size_t MAX_BLOCK_SYMBOLS = 32768;
+
+// Inputs are fed to the match finder in slices so that positions fit the
+// 32-bit hash table entries.
+const size_t MAX_SLICE = static_cast<size_t>(1) << 30;
+
+const unsigned NUM_LITLEN_SYMS = 286;
+const unsigned NUM_DIST_SYMS = 30;
+const unsigned NUM_PRECODE_SYMS = 19;
+const unsigned MAX_CODE_BITS = 15;
+const unsigned MAX_PRECODE_BITS = 7;
+
+const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+const uint8_t PRECODE_ORDER[NUM_PRECODE_SYMS] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// Match finder effort per level, following the classic zlib tuning.
+struct LevelConfig {
+    unsigned goodLength;  // reduce chain search above this previous match length
+    unsigned lazyLength;  // greedy levels: max length whose positions are hashed
+    unsigned niceLength;  // stop searching once a match this long is found
+    unsigned maxChain;
+    bool lazy;
+};
+
+const LevelConfig LEVEL_CONFIG[10] = {
+    {0, 0, 0, 0, false},
+    {0, 0, 0, 1, false},
+    {4, 5, 16, 8, false},
+    {4, 6, 32, 32, false},
+    {4, 4, 16, 16, true},
+    {8, 16, 32, 32, true},
+    {8, 16, 128, 128, true},
+    {8, 32, 128, 256, true},
+    {32, 128, 258, 1024, true},
+    {32, 258, 258, 4096, true}
+};
+
+struct SymbolTables {
+    uint8_t lengthSymbol[MAX_MATCH + 1];   // match length -> index into LENGTH_BASE
+    uint8_t distSymbol[512];               // see distanceSymbol()
+    uint8_t fixedLitlenLengths[288];
+    uint8_t fixedDistLengths[32];
+    uint16_t fixedLitlenCodes[288];
+    uint16_t fixedDistCodes[32];
+
+    SymbolTables();
+};
+
+inline unsigned distanceSymbol(const SymbolTables& tables, unsigned distance) {
+    unsigned d = distance - 1;
+    return d < 256 ? tables.distSymbol[d] : tables.distSymbol[256 + (d >> 7)];
+}
+
+SymbolTables::SymbolTables() {
+    for (unsigned i = 0; i < 29; i++) {
+        unsigned end = i + 1 < 29 ? LENGTH_BASE[i + 1] : MAX_MATCH + 1;
+        for (unsigned len = LENGTH_BASE[i]; len < end && len <= MAX_MATCH; len++) {
+            lengthSymbol[len] = static_cast<uint8_t>(i);
+        }
+    }
+    lengthSymbol[MAX_MATCH] = 28;
+
+    for (unsigned i = 0; i < 30; i++) {
+        unsigned first = DIST_BASE[i] - 1;
+        unsigned last = first + (1u << DIST_EXTRA[i]);
+        for (unsigned d = first; d < last; d++) {
+            if (d < 256) {
+                distSymbol[d] = static_cast<uint8_t>(i);
+            } else {
+                distSymbol[256 + (d >> 7)] = static_cast<uint8_t>(i);
+            }
+        }
+    }
+
+    std::fill(fixedLitlenLengths, fixedLitlenLengths + 144, 8);
+    std::fill(fixedLitlenLengths + 144, fixedLitlenLengths + 256, 9);
+    std::fill(fixedLitlenLengths + 256, fixedLitlenLengths + 280, 7);
+    std::fill(fixedLitlenLengths + 280, fixedLitlenLengths + 288, 8);
+    std::fill(fixedDistLengths, fixedDistLengths + 32, 5);
+    HuffmanCoder::assignCodes(fixedLitlenLengths, 288, fixedLitlenCodes);
+    HuffmanCoder::assignCodes(fixedDistLengths, 32, fixedDistCodes);
+}
+
+const SymbolTables& symbolTables() {
+    static const SymbolTables tables;
+    return tables;
+}
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+
+inline uint32_t hash4(const uint8_t* p) {
+    return (load32(p) * 0x9E3779B1u) >> (32 - HASH_BITS);
+}
+
+inline unsigned matchLength(const uint8_t* a, const uint8_t* b, unsigned maxLength) {
+    unsigned length = 0;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (length + 8 <= maxLength) {
+        uint64_t x, y;
+        std::memcpy(&x, a + length, 8);
+        std::memcpy(&y, b + length, 8);
+        uint64_t diff = x ^ y;
+        if (diff != 0) {
+            return length + (__builtin_ctzll(diff) >> 3);
+        }
+        length += 8;
+    }
+#endif
+    while (length < maxLength && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+} // namespace
+
+const int Deflater::MIN_LEVEL;
+const int Deflater::MAX_LEVEL;
+const int Deflater::DEFAULT_LEVEL;
+const size_t Deflater::SEGMENT_SIZE;
+
+Deflater::Deflater(int level) {
+    setLevel(level);
+}
+
+void Deflater::setLevel(int newLevel) {
+    level = std::max(MIN_LEVEL, std::min(MAX_LEVEL, newLevel));
+}
+
+void Deflater::BitWriter::flush32() {
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(buffer),
+        static_cast<uint8_t>(buffer >> 8),
+        static_cast<uint8_t>(buffer >> 16),
+        static_cast<uint8_t>(buffer >> 24)
+    };
+    out.insert(out.end(), bytes, bytes + 4);
+    buffer >>= 32;
+    count -= 32;
+}
+
+void Deflater::BitWriter::alignToByte() {
+    count = (count + 7) & ~7u;
+    flush();
+}
+
+void Deflater::BitWriter::flush() {
+    while (count >= 8) {
+        out.push_back(static_cast<uint8_t>(buffer));
+        buffer >>= 8;
+        count -= 8;
+    }
+}
+
+void Deflater::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(level == 0 ? size + size / MAX_STORED_BLOCK * 5 + 16 : size / 2 + 64);
+    writeHeader(out);
+    compressSegment(data, 0, size, true, out);
+    writeTrailer(Adler32::update(1, data, size), out);
+}
+
+void Deflater::compressParallel(const uint8_t* data, size_t size, ThreadPool& pool,
+                                std::vector<std::vector<uint8_t> >& pieces) {
+    size_t count = std::max<size_t>(1, (size + SEGMENT_SIZE - 1) / SEGMENT_SIZE);
+    pieces.assign(count, std::vector<uint8_t>());
+    std::vector<uint32_t> checksums(count);
+    writeHeader(pieces[0]);
+
+    int segmentLevel = level;
+    pool.parallelFor(count, 1, [&](size_t begin, size_t end) {
+        // Every thread reuses one encoder's match tables for its segments.
+        thread_local Deflater deflater;
+        deflater.setLevel(segmentLevel);
+        for (size_t i = begin; i < end; i++) {
+            size_t offset = i * SEGMENT_SIZE;
+            size_t length = std::min(SEGMENT_SIZE, size - offset);
+            size_t dictSize = std::min(WINDOW_SIZE, offset);
+            deflater.compressSegment(data + offset - dictSize, dictSize, length, i + 1 == count, pieces[i]);
+            checksums[i] = Adler32::update(1, data + offset, length);
+        }
+    });
+
+    uint32_t adler = checksums[0];
+    for (size_t i = 1; i < count; i++) {
+        adler = Adler32::combine(adler, checksums[i], std::min(SEGMENT_SIZE, size - i * SEGMENT_SIZE));
+    }
+    writeTrailer(adler, pieces.back());
+}
+
+void Deflater::compressSegment(const uint8_t* data, size_t dictSize, size_t size, bool final,
+                               std::vector<uint8_t>& out) {
+    BitWriter writer(out);
+    if (level == 0 || size == 0) {
+        compressStored(data + dictSize, size, writer, final);
+    } else {
+        size_t offset = 0;
+        while (offset < size) {
+            size_t sliceSize = std::min(MAX_SLICE, size - offset);
+            size_t sliceDict = std::min(WINDOW_SIZE, dictSize + offset);
+            bool last = final && offset + sliceSize == size;
+            const uint8_t* slice = data + dictSize + offset;
+            compressSlice(slice - sliceDict, sliceDict, sliceDict + sliceSize, writer, last);
+            offset += sliceSize;
+        }
+        if (!final) {
+            // Sync flush: an empty stored block leaves the stream byte aligned.
+            compressStored(nullptr, 0, writer, false);
+        }
+    }
+    writer.alignToByte();
+}
+
+void Deflater::writeHeader(std::vector<uint8_t>& out) const {
+    static const uint8_t LEVEL_FLAGS[10] = {0x01, 0x01, 0x5E, 0x5E, 0x5E, 0x5E, 0x9C, 0xDA, 0xDA, 0xDA};
+    out.push_back(0x78);
+    out.push_back(LEVEL_FLAGS[level]);
+}
+
+void Deflater::writeTrailer(uint32_t adler, std::vector<uint8_t>& out) {
+    out.push_back(static_cast<uint8_t>(adler >> 24));
+    out.push_back(static_cast<uint8_t>(adler >> 16));
+    out.push_back(static_cast<uint8_t>(adler >> 8));
+    out.push_back(static_cast<uint8_t>(adler));
+}
+
+void Deflater::compressStored(const uint8_t* data, size_t size, BitWriter& writer, bool final) {
+    do {
+        size_t blockSize = std::min(size, MAX_STORED_BLOCK);
+        bool last = final && blockSize == size;
+        writer.write(last ? 1 : 0, 1);
+        writer.write(0, 2);
+        writer.alignToByte();
+        writer.write(static_cast<uint32_t>(blockSize), 16);
+        writer.write(static_cast<uint32_t>(~blockSize & 0xFFFF), 16);
+        writer.flush();
+        writer.append(data, blockSize);
+        data += blockSize;
+        size -= blockSize;
+    } while (size > 0);
+}
+
+void Deflater::compressSlice(const uint8_t* src, size_t start, size_t end, BitWriter& writer, bool final) {
+    const LevelConfig& config = LEVEL_CONFIG[level];
+    head.assign(HASH_SIZE, 0);
+    prev.assign(config.maxChain > 1 ? WINDOW_SIZE : 0, 0);
+    symbols.clear();
+    symbols.reserve(MAX_BLOCK_SYMBOLS + 1);
+
+    // Positions are stored as index + 1 so that zero means "empty".
+    bool chained = !prev.empty();
+    for (size_t pos = 0; pos + MIN_MATCH <= end && pos < start; pos++) {
+        uint32_t h = hash4(src + pos);
+        if (chained) {
+            prev[pos & WINDOW_MASK] = head[h];
+        }
+        head[h] = static_cast<uint32_t>(pos + 1);
+    }
+
+    size_t blockStart = start;
+    size_t pos = start;
+
+    if (!chained) {
+        // Level 1: greedy parse, one hash probe per position, no chains.
+        while (pos + MIN_MATCH <= end) {
+            uint32_t h = hash4(src + pos);
+            size_t candidate = head[h];
+            head[h] = static_cast<uint32_t>(pos + 1);
+
+            if (candidate != 0 && pos - (candidate - 1) <= WINDOW_SIZE &&
+                load32(src + candidate - 1) == load32(src + pos)) {
+                size_t matchPos = candidate - 1;
+                unsigned maxLength = static_cast<unsigned>(std::min<size_t>(MAX_MATCH, end - pos));
+                unsigned length = MIN_MATCH + matchLength(src + matchPos + MIN_MATCH, src + pos + MIN_MATCH,
+                                                          maxLength - MIN_MATCH);
+                Symbol symbol = {static_cast<uint16_t>(256 + length), static_cast<uint16_t>(pos - matchPos)};
+                symbols.push_back(symbol);
+                pos += length;
+            } else {
+                Symbol symbol = {src[pos], 0};
+                symbols.push_back(symbol);
+                pos++;
+            }
+
+            if (symbols.size() >= MAX_BLOCK_SYMBOLS) {
+                flushBlock(src + blockStart, pos - blockStart, writer, false);
+                blockStart = pos;
+            }
+        }
+    } else if (!config.lazy) {
+        // Levels 2-3: greedy parse over hash chains.
+        while (pos + MIN_MATCH <= end) {
+            unsigned distance = 0;
+            unsigned length = findMatch(src, pos, end, 0, distance);
+            if (length >= MIN_MATCH) {
+                Symbol symbol = {static_cast<uint16_t>(256 + length), static_cast<uint16_t>(distance)};
+                symbols.push_back(symbol);
+                if (length <= config.lazyLength) {
+                    for (size_t p = pos + 1; p < pos + length && p + MIN_MATCH <= end; p++) {
+                        insertHash(src, p);
+                    }
+                }
+                pos += length;
+            } else {
+                Symbol symbol = {src[pos], 0};
+                symbols.push_back(symbol);
+                pos++;
+            }
+
+            if (symbols.size() >= MAX_BLOCK_SYMBOLS) {
+                flushBlock(src + blockStart, pos - blockStart, writer, false);
+                blockStart = pos;
+            }
+        }
+    } else {
+        // Levels 4-9: lazy matching; a match is only taken if the match
+        // starting one byte later is not longer.
+        unsigned prevLength = 0;
+        unsigned prevDistance = 0;
+        bool pending = false;
+
+        while (pos < end) {
+            unsigned length = 0;
+            unsigned distance = 0;
+            if (pos + MIN_MATCH <= end) {
+                if (pending && prevLength >= config.lazyLength) {
+                    insertHash(src, pos);
+                } else {
+                    length = findMatch(src, pos, end, pending ? prevLength : 0, distance);
+                }
+            }
+
+            if (pending && prevLength >= MIN_MATCH && length <= prevLength) {
+                Symbol symbol = {static_cast<uint16_t>(256 + prevLength), static_cast<uint16_t>(prevDistance)};
+                symbols.push_back(symbol);
+                size_t matchEnd = pos - 1 + prevLength;
+                for (size_t p = pos + 1; p < matchEnd && p + MIN_MATCH <= end; p++) {
+                    insertHash(src, p);
+                }
+                pos = matchEnd;
+                pending = false;
+                prevLength = 0;
+            } else {
+                if (pending) {
+                    Symbol symbol = {src[pos - 1], 0};
+                    symbols.push_back(symbol);
+                }
+                pending = true;
+                prevLength = length;
+                prevDistance = distance;
+                pos++;
+            }
+
+            if (symbols.size() >= MAX_BLOCK_SYMBOLS) {
+                size_t rawEnd = pending ? pos - 1 : pos;
+                flushBlock(src + blockStart, rawEnd - blockStart, writer, false);
+                blockStart = rawEnd;
+            }
+        }
+        if (pending) {
+            Symbol symbol = {src[pos - 1], 0};
+            symbols.push_back(symbol);
+        }
+    }
+
+    while (pos < end) {
+        Symbol symbol = {src[pos++], 0};
+        symbols.push_back(symbol);
+    }
+    flushBlock(src + blockStart, end - blockStart, writer, final);
+}
+
+inline void Deflater::insertHash(const uint8_t* src, size_t pos) {
+    uint32_t h = hash4(src + pos);
+    prev[pos & WINDOW_MASK] = head[h];
+    head[h] = static_cast<uint32_t>(pos + 1);
+}
+
+unsigned Deflater::findMatch(const uint8_t* src, size_t pos, size_t end, unsigned prevLength,
+                             unsigned& distance) {
+    const LevelConfig& config = LEVEL_CONFIG[level];
+    uint32_t h = hash4(src + pos);
+    size_t candidate = head[h];
+    prev[pos & WINDOW_MASK] = static_cast<uint32_t>(candidate);
+    head[h] = static_cast<uint32_t>(pos + 1);
+
+    unsigned maxLength = static_cast<unsigned>(std::min<size_t>(MAX_MATCH, end - pos));
+    if (prevLength >= maxLength) {
+        return 0;
+    }
+    unsigned niceLength = std::min(config.niceLength, maxLength);
+    unsigned chain = prevLength >= config.goodLength ? config.maxChain >> 2 : config.maxChain;
+    unsigned best = std::max(prevLength, MIN_MATCH - 1);
+    const uint8_t* current = src + pos;
+    uint32_t current4 = load32(current);
+
+    while (candidate != 0 && chain-- > 0) {
+        size_t matchPos = candidate - 1;
+        if (pos - matchPos > WINDOW_SIZE) {
+            break;
+        }
+        const uint8_t* match = src + matchPos;
+        if (match[best] == current[best] && load32(match) == current4) {
+            unsigned length = MIN_MATCH + matchLength(match + MIN_MATCH, current + MIN_MATCH,
+                                                      maxLength - MIN_MATCH);
+            if (length > best) {
+                best = length;
+                distance = static_cast<unsigned>(pos - matchPos);
+                if (length >= niceLength) {
+                    break;
+                }
+            }
+        }
+        size_t next = prev[matchPos & WINDOW_MASK];
+        if (next >= candidate) {
+            break;  // slot was overwritten by a newer position
+        }
+        candidate = next;
+    }
+
+    return best > prevLength && best >= MIN_MATCH ? best : 0;
+}
+
+void Deflater::flushBlock(const uint8_t* blockStart, size_t blockSize, BitWriter& writer, bool final) {
+    const SymbolTables& tables = symbolTables();
+
+    uint32_t litlenFreq[NUM_LITLEN_SYMS] = {0};
+    uint32_t distFreq[NUM_DIST_SYMS] = {0};
+    uint64_t extraBits = 0;
+    for (size_t i = 0; i < symbols.size(); i++) {
+        const Symbol& symbol = symbols[i];
+        if (symbol.distance == 0) {
+            litlenFreq[symbol.litlen]++;
+        } else {
+            unsigned lengthSym = tables.lengthSymbol[symbol.litlen - 256];
+            unsigned distSym = distanceSymbol(tables, symbol.distance);
+            litlenFreq[257 + lengthSym]++;
+            distFreq[distSym]++;
+            extraBits += LENGTH_EXTRA[lengthSym] + DIST_EXTRA[distSym];
+        }
+    }
+    litlenFreq[256] = 1;
+
+    // Keep at least two codes in each alphabet; some decoders reject
+    // single-symbol or empty distance codes.
+    unsigned usedDist = 0;
+    for (unsigned i = 0; i < NUM_DIST_SYMS; i++) {
+        usedDist += distFreq[i] != 0;
+    }
+    for (unsigned i = 0; i < NUM_DIST_SYMS && usedDist < 2; i++) {
+        if (distFreq[i] == 0) {
+            distFreq[i] = 1;
+            usedDist++;
+        }
+    }
+
+    uint8_t lengths[NUM_LITLEN_SYMS + NUM_DIST_SYMS];
+    uint8_t* litlenLengths = lengths;
+    uint8_t* distLengths = lengths + NUM_LITLEN_SYMS;
+    HuffmanCoder::buildCodeLengths(litlenFreq, NUM_LITLEN_SYMS, MAX_CODE_BITS, litlenLengths);
+    HuffmanCoder::buildCodeLengths(distFreq, NUM_DIST_SYMS, MAX_CODE_BITS, distLengths);
+
+    unsigned numLitlen = NUM_LITLEN_SYMS;
+    while (numLitlen > 257 && litlenLengths[numLitlen - 1] == 0) {
+        numLitlen--;
+    }
+    unsigned numDist = NUM_DIST_SYMS;
+    while (numDist > 1 && distLengths[numDist - 1] == 0) {
+        numDist--;
+    }
+
+    // Run-length encode the code lengths with the precode alphabet.
+    uint8_t combined[NUM_LITLEN_SYMS + NUM_DIST_SYMS];
+    std::memcpy(combined, litlenLengths, numLitlen);
+    std::memcpy(combined + numLitlen, distLengths, numDist);
+    unsigned total = numLitlen + numDist;
+
+    uint16_t precodeItems[NUM_LITLEN_SYMS + NUM_DIST_SYMS];  // symbol | extra << 5
+    unsigned numItems = 0;
+    uint32_t precodeFreq[NUM_PRECODE_SYMS] = {0};
+    for (unsigned i = 0; i < total;) {
+        uint8_t value = combined[i];
+        unsigned run = 1;
+        while (i + run < total && combined[i + run] == value) {
+            run++;
+        }
+        i += run;
+        if (value == 0) {
+            while (run >= 11) {
+                unsigned n = std::min(run, 138u);
+                precodeItems[numItems++] = static_cast<uint16_t>(18 | ((n - 11) << 5));
+                precodeFreq[18]++;
+                run -= n;
+            }
+            if (run >= 3) {
+                precodeItems[numItems++] = static_cast<uint16_t>(17 | ((run - 3) << 5));
+                precodeFreq[17]++;
+                run = 0;
+            }
+        } else {
+            precodeItems[numItems++] = value;
+            precodeFreq[value]++;
+            run--;
+            while (run >= 3) {
+                unsigned n = std::min(run, 6u);
+                precodeItems[numItems++] = static_cast<uint16_t>(16 | ((n - 3) << 5));
+                precodeFreq[16]++;
+                run -= n;
+            }
+        }
+        while (run > 0) {
+            precodeItems[numItems++] = value;
+            precodeFreq[value]++;
+            run--;
+        }
+    }
+
+    uint8_t precodeLengths[NUM_PRECODE_SYMS];
+    uint16_t precodeCodes[NUM_PRECODE_SYMS];
+    HuffmanCoder::buildCodeLengths(precodeFreq, NUM_PRECODE_SYMS, MAX_PRECODE_BITS, precodeLengths);
+    HuffmanCoder::assignCodes(precodeLengths, NUM_PRECODE_SYMS, precodeCodes);
+    unsigned numPrecode = NUM_PRECODE_SYMS;
+    while (numPrecode > 4 && precodeLengths[PRECODE_ORDER[numPrecode - 1]] == 0) {
+        numPrecode--;
+    }
+
+    // Cost of each block type, in bits.
+    uint64_t dynamicCost = 3 + 5 + 5 + 4 + 3 * numPrecode + extraBits;
+    for (unsigned i = 0; i < numItems; i++) {
+        unsigned sym = precodeItems[i] & 0x1F;
+        dynamicCost += precodeLengths[sym] + (sym == 16 ? 2 : sym == 17 ? 3 : sym == 18 ? 7 : 0);
+    }
+    uint64_t fixedCost = 3 + extraBits;
+    for (unsigned i = 0; i < NUM_LITLEN_SYMS; i++) {
+        dynamicCost += static_cast<uint64_t>(litlenFreq[i]) * litlenLengths[i];
+        fixedCost += static_cast<uint64_t>(litlenFreq[i]) * tables.fixedLitlenLengths[i];
+    }
+    for (unsigned i = 0; i < NUM_DIST_SYMS; i++) {
+        dynamicCost += static_cast<uint64_t>(distFreq[i]) * distLengths[i];
+        fixedCost += static_cast<uint64_t>(distFreq[i]) * tables.fixedDistLengths[i];
+    }
+    uint64_t storedCost = (blockSize / MAX_STORED_BLOCK + 1) * 40 + static_cast<uint64_t>(blockSize) * 8;
+
+    if (storedCost <= dynamicCost && storedCost <= fixedCost) {
+        compressStored(blockStart, blockSize, writer, final);
+        symbols.clear();
+        return;
+    }
+
+    uint16_t litlenCodes[NUM_LITLEN_SYMS];
+    uint16_t distCodes[NUM_DIST_SYMS];
+    const uint8_t* useLitlenLengths;
+    const uint8_t* useDistLengths;
+    const uint16_t* useLitlenCodes;
+    const uint16_t* useDistCodes;
+
+    if (fixedCost <= dynamicCost) {
+        writer.write(final ? 1 : 0, 1);
+        writer.write(1, 2);
+        useLitlenLengths = tables.fixedLitlenLengths;
+        useDistLengths = tables.fixedDistLengths;
+        useLitlenCodes = tables.fixedLitlenCodes;
+        useDistCodes = tables.fixedDistCodes;
+    } else {
+        HuffmanCoder::assignCodes(litlenLengths, NUM_LITLEN_SYMS, litlenCodes);
+        HuffmanCoder::assignCodes(distLengths, NUM_DIST_SYMS, distCodes);
+
+        writer.write(final ? 1 : 0, 1);
+        writer.write(2, 2);
+        writer.write(numLitlen - 257, 5);
+        writer.write(numDist - 1, 5);
+        writer.write(numPrecode - 4, 4);
+        for (unsigned i = 0; i < numPrecode; i++) {
+            writer.write(precodeLengths[PRECODE_ORDER[i]], 3);
+        }
+        for (unsigned i = 0; i < numItems; i++) {
+            unsigned sym = precodeItems[i] & 0x1F;
+            unsigned extra = precodeItems[i] >> 5;
+            writer.write(precodeCodes[sym], precodeLengths[sym]);
+            if (sym == 16) {
+                writer.write(extra, 2);
+            } else if (sym == 17) {
+                writer.write(extra, 3);
+            } else if (sym == 18) {
+                writer.write(extra, 7);
+            }
+        }
+        useLitlenLengths = litlenLengths;
+        useDistLengths = distLengths;
+        useLitlenCodes = litlenCodes;
+        useDistCodes = distCodes;
+    }
+
+    for (size_t i = 0; i < symbols.size(); i++) {
+        const Symbol& symbol = symbols[i];
+        if (symbol.distance == 0) {
+            writer.write(useLitlenCodes[symbol.litlen], useLitlenLengths[symbol.litlen]);
+            continue;
+        }
+        unsigned length = symbol.litlen - 256;
+        unsigned lengthSym = tables.lengthSymbol[length];
+        writer.write(useLitlenCodes[257 + lengthSym], useLitlenLengths[257 + lengthSym]);
+        writer.write(length - LENGTH_BASE[lengthSym], LENGTH_EXTRA[lengthSym]);
+
+        unsigned distSym = distanceSymbol(tables, symbol.distance);
+        writer.write(useDistCodes[distSym], useDistLengths[distSym]);
+        writer.write(symbol.distance - DIST_BASE[distSym], DIST_EXTRA[distSym]);
+    }
+    writer.write(useLitlenCodes[256], useLitlenLengths[256]);
+    symbols.clear();
+}
@@ -0,0 +1,128 @@
+#ifndef DEFLATER_H
+#define DEFLATER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @file Deflater.h
+ * @brief Contains the Deflater class, a zlib/deflate encoder with selectable effort
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Encodes data as a zlib stream (RFC 1950/1951)
+ *
+ * Level 0 emits stored blocks only. Level 1 is a greedy parser with a single
+ * hash probe per position, levels 2-3 greedy with short hash chains and levels
+ * 4-9 lazy matching with progressively longer chains. Every block is emitted
+ * with whichever of the stored, fixed or dynamic Huffman encodings is smallest.
+ *
+ * Large inputs can also be compressed pigz-style: cut into segments that are
+ * deflated in parallel, each primed with the 32 KB before it and ended on a
+ * byte boundary, so that the segments concatenate into one valid stream.
+ */
+class Deflater {
+public:
+    static const int MIN_LEVEL = 0;
+    static const int MAX_LEVEL = 9;
+    static const int DEFAULT_LEVEL = 6;
+    /// Input bytes per independently deflated segment of compressParallel()
+    static const size_t SEGMENT_SIZE = 256 * 1024;
+
+    /**
+     * @brief Constructor
+     * @param level Compression level, clamped to [MIN_LEVEL, MAX_LEVEL]
+     */
+    explicit Deflater(int level = DEFAULT_LEVEL);
+
+    /**
+     * @brief Sets the compression level used by subsequent calls
+     * @param level Compression level, clamped to [MIN_LEVEL, MAX_LEVEL]
+     */
+    void setLevel(int level);
+    int getLevel() const { return level; }
+
+    /**
+     * @brief Compresses a buffer into a complete zlib stream
+     * @param data Bytes to compress
+     * @param size Number of bytes
+     * @param out Receives the zlib stream (header, deflate data, Adler-32)
+     */
+    void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Compresses a buffer into a zlib stream split into pieces, deflating segments in parallel
+     *
+     * The first piece starts with the zlib header and the last ends with the
+     * Adler-32, combined from the checksums of the segments. Every segment
+     * but the last ends with a sync flush. The output depends on the level
+     * and the segment size only, not on the number of threads.
+     * @param data Bytes to compress
+     * @param size Number of bytes
+     * @param pool Pool the segments are deflated on
+     * @param pieces Receives one piece per SEGMENT_SIZE bytes of input, at least one
+     */
+    void compressParallel(const uint8_t* data, size_t size, ThreadPool& pool,
+                          std::vector<std::vector<uint8_t> >& pieces);
+
+    /**
+     * @brief Appends one segment of a stream as raw deflate data
+     *
+     * Matches may reach into the dictSize bytes before the segment. Unless
+     * the segment is the final one it ends with an empty stored block, so
+     * the next segment starts on a byte boundary with a fresh block.
+     * @param data First byte of the dictionary, followed by the segment
+     * @param dictSize Bytes of history before the segment, at most 32 KB are used
+     * @param size Number of bytes in the segment
+     * @param final Whether the segment ends the stream
+     * @param out Receives the deflate data, appended
+     */
+    void compressSegment(const uint8_t* data, size_t dictSize, size_t size, bool final,
+                         std::vector<uint8_t>& out);
+
+private:
+    struct Symbol {
+        uint16_t litlen;    // literal byte, 256 + length for matches
+        uint16_t distance;  // 0 for literals
+    };
+
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) : out(out), buffer(0), count(0) {}
+        inline void write(uint32_t value, unsigned bits) {
+            buffer |= static_cast<uint64_t>(value) << count;
+            count += bits;
+            if (count >= 32) {
+                flush32();
+            }
+        }
+        void alignToByte();
+        void flush();
+        void append(const uint8_t* data, size_t size) { out.insert(out.end(), data, data + size); }
+    private:
+        std::vector<uint8_t>& out;
+        uint64_t buffer;
+        unsigned count;
+        void flush32();
+    };
+
+    int level;
+    std::vector<Symbol> symbols;
+    std::vector<uint32_t> head;
+    std::vector<uint32_t> prev;
+
+    void writeHeader(std::vector<uint8_t>& out) const;
+    static void writeTrailer(uint32_t adler, std::vector<uint8_t>& out);
+    void compressStored(const uint8_t* data, size_t size, BitWriter& writer, bool final);
+    void compressSlice(const uint8_t* src, size_t start, size_t end, BitWriter& writer, bool final);
+    unsigned findMatch(const uint8_t* src, size_t pos, size_t end, unsigned prevLength, unsigned& distance);
+    inline void insertHash(const uint8_t* src, size_t pos);
+    void flushBlock(const uint8_t* blockStart, size_t blockSize, BitWriter& writer, bool final);
+};
+
+#endif // DEFLATER_H
@@ -0,0 +1,120 @@
+#include "FilterSelector.h"
+#include "PNGFilter.h"
+#include "Deflater.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/**
+ * @file FilterSelector.cpp
+ * @brief Implementation of FilterSelector class and the built-in heuristics
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const size_t NUM_FILTERS = 5;
+
+// Rows handed to a worker at once; keeps tasks around 64 KB of pixels.
+const size_t TARGET_TASK_BYTES = 64 * 1024;
+
+const MinSumHeuristic MIN_SUM_HEURISTIC;
+const EntropyHeuristic ENTROPY_HEURISTIC;
+const TrialDeflateHeuristic TRIAL_DEFLATE_HEURISTIC;
+
+} // namespace
+
+double MinSumHeuristic::score(const uint8_t* filtered, size_t length) const {
+    // Bytes are read as signed so that small negative residuals score low.
+    uint64_t sum = 0;
+    for (size_t i = 0; i < length; i++) {
+        int value = static_cast<int8_t>(filtered[i]);
+        sum += static_cast<uint64_t>(value < 0 ? -value : value);
+    }
+    return static_cast<double>(sum);
+}
+
+double EntropyHeuristic::score(const uint8_t* filtered, size_t length) const {
+    if (length == 0) {
+        return 0.0;
+    }
+    uint32_t histogram[256] = {0};
+    for (size_t i = 0; i < length; i++) {
+        histogram[filtered[i]]++;
+    }
+    // Total bits for an order-0 code: n*log2(n) - sum(c*log2(c)).
+    double bits = static_cast<double>(length) * std::log2(static_cast<double>(length));
+    for (unsigned i = 0; i < 256; i++) {
+        if (histogram[i] > 1) {
+            bits -= histogram[i] * std::log2(static_cast<double>(histogram[i]));
+        }
+    }
+    return bits;
+}
+
+double TrialDeflateHeuristic::score(const uint8_t* filtered, size_t length) const {
+    thread_local Deflater deflater(1);
+    thread_local std::vector<uint8_t> output;
+    deflater.compress(filtered, length, output);
+    return static_cast<double>(output.size());
+}
+
+FilterSelector::FilterSelector(FilterStrategy strategy, ThreadPool* pool)
+    : strategy(strategy), heuristic(nullptr), pool(pool) {
+    switch (strategy) {
+        case FilterStrategy::MIN_SUM: heuristic = &MIN_SUM_HEURISTIC; break;
+        case FilterStrategy::ENTROPY: heuristic = &ENTROPY_HEURISTIC; break;
+        case FilterStrategy::TRIAL_DEFLATE: heuristic = &TRIAL_DEFLATE_HEURISTIC; break;
+        default: break;
+    }
+}
+
+FilterSelector::FilterSelector(const FilterHeuristic& heuristic, ThreadPool* pool)
+    : strategy(FilterStrategy::MIN_SUM), heuristic(&heuristic), pool(pool) {}
+
+void FilterSelector::filterImage(const uint8_t* pixels, size_t stride, size_t height,
+                                 size_t bytesPerPixel, uint8_t* out) const {
+    // Every row is filtered against the original previous row, so rows are
+    // independent and can be scored on any thread.
+    ThreadPool& workers = pool ? *pool : ThreadPool::shared();
+    size_t rowsPerTask = std::max<size_t>(1, TARGET_TASK_BYTES / (stride + 1));
+    workers.parallelFor(height, rowsPerTask, [&](size_t begin, size_t end) {
+        filterRows(pixels, stride, bytesPerPixel, out, begin, end);
+    });
+}
+
+void FilterSelector::filterRows(const uint8_t* pixels, size_t stride, size_t bytesPerPixel,
+                                uint8_t* out, size_t begin, size_t end) const {
+    std::vector<uint8_t> zeroRow(stride, 0);
+    std::vector<uint8_t> candidates(heuristic ? NUM_FILTERS * stride : 0);
+
+    for (size_t y = begin; y < end; y++) {
+        const uint8_t* row = pixels + y * stride;
+        const uint8_t* prior = y > 0 ? row - stride : zeroRow.data();
+        uint8_t* dest = out + y * (stride + 1);
+
+        if (!heuristic) {
+            FilterType type = static_cast<FilterType>(static_cast<int>(strategy));
+            dest[0] = static_cast<uint8_t>(type);
+            PNGFilter::filterRow(type, dest + 1, row, prior, stride, bytesPerPixel);
+            continue;
+        }
+
+        size_t best = 0;
+        double bestScore = 0.0;
+        for (size_t f = 0; f < NUM_FILTERS; f++) {
+            uint8_t* candidate = candidates.data() + f * stride;
+            PNGFilter::filterRow(static_cast<FilterType>(f), candidate, row, prior, stride, bytesPerPixel);
+            double score = heuristic->score(candidate, stride);
+            if (f == 0 || score < bestScore) {
+                best = f;
+                bestScore = score;
+            }
+        }
+        dest[0] = static_cast<uint8_t>(best);
+        std::memcpy(dest + 1, candidates.data() + best * stride, stride);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef FILTER_SELECTOR_H
+#define FILTER_SELECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "PNGStructs.h"
+
+class ThreadPool;
+
+/**
+ * @file FilterSelector.h
+ * @brief Contains FilterSelector class for choosing PNG filters per scanline
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+// How the encoder picks the filter of each scanline
+enum class FilterStrategy {
+    NONE,           // always filter type 0
+    SUB,            // always filter type 1
+    UP,             // always filter type 2
+    AVERAGE,        // always filter type 3
+    PAETH,          // always filter type 4
+    MIN_SUM,        // adaptive: minimum sum of absolute signed differences
+    ENTROPY,        // adaptive: lowest order-0 entropy estimate
+    TRIAL_DEFLATE   // adaptive: smallest output of a trial deflate
+};
+
+/**
+ * @brief Scores a filtered scanline; lower scores are expected to compress better
+ */
+class FilterHeuristic {
+public:
+    virtual ~FilterHeuristic() {}
+
+    /**
+     * @brief Scores one candidate
+     * @param filtered Filtered scanline bytes (without the filter type byte)
+     * @param length Number of bytes
+     * @return Score, lower is better
+     */
+    virtual double score(const uint8_t* filtered, size_t length) const = 0;
+};
+
+class MinSumHeuristic : public FilterHeuristic {
+public:
+    double score(const uint8_t* filtered, size_t length) const override;
+};
+
+class EntropyHeuristic : public FilterHeuristic {
+public:
+    double score(const uint8_t* filtered, size_t length) const override;
+};
+
+class TrialDeflateHeuristic : public FilterHeuristic {
+public:
+    double score(const uint8_t* filtered, size_t length) const override;
+};
+
+class FilterSelector {
+public:
+    /**
+     * @brief Constructor for one of the built-in strategies
+     * @param strategy Fixed filter or built-in heuristic
+     * @param pool Pool to score rows on, nullptr for the shared pool
+     */
+    explicit FilterSelector(FilterStrategy strategy = FilterStrategy::MIN_SUM, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Constructor for a caller-supplied heuristic (must outlive the selector)
+     * @param heuristic Heuristic used to score the five candidate filters
+     * @param pool Pool to score rows on, nullptr for the shared pool
+     */
+    explicit FilterSelector(const FilterHeuristic& heuristic, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Filters every scanline of an image into PNG scanline layout
+     * @param pixels Unfiltered rows, stride bytes each
+     * @param stride Number of bytes per row
+     * @param height Number of rows
+     * @param bytesPerPixel Filter pixel size in bytes
+     * @param out Destination of height * (stride + 1) bytes: filter type then filtered row
+     */
+    void filterImage(const uint8_t* pixels, size_t stride, size_t height,
+                     size_t bytesPerPixel, uint8_t* out) const;
+
+private:
+    FilterStrategy strategy;
+    const FilterHeuristic* heuristic;
+    ThreadPool* pool;
+
+    void filterRows(const uint8_t* pixels, size_t stride, size_t bytesPerPixel,
+                    uint8_t* out, size_t begin, size_t end) const;
+};
+
+#endif // FILTER_SELECTOR_H
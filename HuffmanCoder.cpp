@@ -0,0 +1,346 @@
+#include "HuffmanCoder.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @file HuffmanCoder.cpp
+ * @brief Implementation of the HuffmanCoder class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const size_t TABLE_SIZE = static_cast<size_t>(1) << HuffmanCoder::BLOCK_CODE_BITS;
+const uint64_t TABLE_MASK = TABLE_SIZE - 1;
+
+// Single-code table entry: symbol in bits 0-7, code length in bits 8-11,
+// 0 for bit patterns no code starts with.
+inline uint16_t singleEntry(unsigned symbol, unsigned length) {
+    return static_cast<uint16_t>(symbol | (length << 8));
+}
+
+// Two-code table entry: first symbol in bits 0-7, second in bits 8-15, bits
+// used in 16-19 and number of symbols (0 to 2) in bits 20-21.
+inline uint32_t multiEntry(unsigned first, unsigned second, unsigned bits, unsigned count) {
+    return first | (second << 8) | (bits << 16) | (count << 20);
+}
+
+// LSB-first bit reader that pads the input with zero bytes and counts them,
+// so that the decode loops need no end-of-input checks.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : pos(data), end(data + size), buffer(0), count(0), padding(0) {}
+
+    inline void refill() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (end - pos >= 8) {
+            // Bits above count may already hold the next bytes; loading them
+            // again at the same place leaves them unchanged.
+            uint64_t value;
+            std::memcpy(&value, pos, 8);
+            buffer |= value << count;
+            pos += (63 - count) >> 3;
+            count |= 56;
+            return;
+        }
+#endif
+        while (count <= 56) {
+            uint64_t byte = 0;
+            if (pos < end) {
+                byte = *pos++;
+            } else {
+                padding++;
+            }
+            buffer |= byte << count;
+            count += 8;
+        }
+    }
+
+    inline uint64_t peek() const { return buffer; }
+
+    inline void consume(unsigned bits) {
+        buffer >>= bits;
+        count -= bits;
+    }
+
+    // Number of bytes the consumed bits reach into, padding included
+    size_t bytesUsed(const uint8_t* start) const {
+        size_t bits = (static_cast<size_t>(pos - start) + padding) * 8 - count;
+        return (bits + 7) / 8;
+    }
+
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+    uint64_t buffer;
+    unsigned count;
+    size_t padding;
+};
+
+} // namespace
+
+const unsigned HuffmanCoder::MAX_SYMBOLS;
+const unsigned HuffmanCoder::MAX_CODE_LENGTH;
+const unsigned HuffmanCoder::BLOCK_CODE_BITS;
+const size_t HuffmanCoder::LENGTHS_SIZE;
+
+unsigned HuffmanCoder::reverseBits(unsigned code, unsigned length) {
+    unsigned result = 0;
+    for (unsigned i = 0; i < length; i++) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+void HuffmanCoder::assignCodes(const uint8_t* lengths, unsigned numSyms, uint16_t* codes) {
+    unsigned count[MAX_CODE_LENGTH + 1] = {0};
+    for (unsigned i = 0; i < numSyms; i++) {
+        count[lengths[i]]++;
+    }
+    count[0] = 0;
+
+    unsigned nextCode[MAX_CODE_LENGTH + 1];
+    unsigned code = 0;
+    nextCode[0] = 0;
+    for (unsigned len = 1; len <= MAX_CODE_LENGTH; len++) {
+        code = (code + count[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+    for (unsigned i = 0; i < numSyms; i++) {
+        codes[i] = lengths[i] ? static_cast<uint16_t>(reverseBits(nextCode[lengths[i]]++, lengths[i])) : 0;
+    }
+}
+
+/**
+ * Optimal lengths come from the in-place Moffat-Katajainen algorithm, then
+ * the Kraft sum is repaired by pushing codes that exceed maxBits back down
+ * (as in miniz).
+ */
+void HuffmanCoder::buildCodeLengths(const uint32_t* freq, unsigned numSyms, unsigned maxBits, uint8_t* lengths) {
+    struct Entry {
+        uint32_t key;
+        uint16_t symbol;
+    };
+    Entry entries[MAX_SYMBOLS];
+    unsigned n = 0;
+
+    std::memset(lengths, 0, numSyms);
+    for (unsigned i = 0; i < numSyms; i++) {
+        if (freq[i] != 0) {
+            entries[n].key = freq[i];
+            entries[n].symbol = static_cast<uint16_t>(i);
+            n++;
+        }
+    }
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        lengths[entries[0].symbol] = 1;
+        return;
+    }
+
+    std::stable_sort(entries, entries + n, [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    uint16_t sortedSymbols[MAX_SYMBOLS];
+    for (unsigned i = 0; i < n; i++) {
+        sortedSymbols[i] = entries[i].symbol;
+    }
+
+    // Moffat-Katajainen: turn sorted weights into code lengths in place.
+    int root = 0;
+    int leaf = 2;
+    int count = static_cast<int>(n);
+    entries[0].key += entries[1].key;
+    for (int next = 1; next < count - 1; next++) {
+        if (leaf >= count || entries[root].key < entries[leaf].key) {
+            entries[next].key = entries[root].key;
+            entries[root++].key = static_cast<uint32_t>(next);
+        } else {
+            entries[next].key = entries[leaf++].key;
+        }
+        if (leaf >= count || (root < next && entries[root].key < entries[leaf].key)) {
+            entries[next].key += entries[root].key;
+            entries[root++].key = static_cast<uint32_t>(next);
+        } else {
+            entries[next].key += entries[leaf++].key;
+        }
+    }
+    entries[count - 2].key = 0;
+    for (int next = count - 3; next >= 0; next--) {
+        entries[next].key = entries[entries[next].key].key + 1;
+    }
+    int available = 1;
+    int used = 0;
+    uint32_t depth = 0;
+    root = count - 2;
+    int next = count - 1;
+    while (available > 0) {
+        while (root >= 0 && entries[root].key == depth) {
+            used++;
+            root--;
+        }
+        while (available > used) {
+            entries[next--].key = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+
+    // Count codes per length, folding everything longer than maxBits.
+    unsigned numCodes[64] = {0};
+    for (unsigned i = 0; i < n; i++) {
+        numCodes[std::min<uint32_t>(entries[i].key, 63)]++;
+    }
+    for (unsigned len = maxBits + 1; len < 64; len++) {
+        numCodes[maxBits] += numCodes[len];
+        numCodes[len] = 0;
+    }
+    uint32_t total = 0;
+    for (unsigned len = maxBits; len > 0; len--) {
+        total += numCodes[len] << (maxBits - len);
+    }
+    while (total != (1u << maxBits)) {
+        numCodes[maxBits]--;
+        for (unsigned len = maxBits - 1; len > 0; len--) {
+            if (numCodes[len] != 0) {
+                numCodes[len]--;
+                numCodes[len + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // Least frequent symbols get the longest codes.
+    unsigned j = 0;
+    for (unsigned len = maxBits; len > 0; len--) {
+        for (unsigned k = numCodes[len]; k > 0; k--) {
+            lengths[sortedSymbols[j++]] = static_cast<uint8_t>(len);
+        }
+    }
+}
+
+size_t HuffmanCoder::encode(const uint8_t* data, size_t size, uint8_t* out) {
+    uint32_t freq[256] = {0};
+    for (size_t i = 0; i < size; i++) {
+        freq[data[i]]++;
+    }
+    uint8_t lengths[256];
+    uint16_t codes[256];
+    buildCodeLengths(freq, 256, BLOCK_CODE_BITS, lengths);
+    assignCodes(lengths, 256, codes);
+    for (size_t i = 0; i < LENGTHS_SIZE; i++) {
+        out[i] = static_cast<uint8_t>(lengths[2 * i] | (lengths[2 * i + 1] << 4));
+    }
+
+    uint8_t* op = out + LENGTHS_SIZE;
+    uint64_t buffer = 0;
+    unsigned count = 0;
+    for (size_t i = 0; i < size; i++) {
+        buffer |= static_cast<uint64_t>(codes[data[i]]) << count;
+        count += lengths[data[i]];
+        if (count >= 32) {
+            op[0] = static_cast<uint8_t>(buffer);
+            op[1] = static_cast<uint8_t>(buffer >> 8);
+            op[2] = static_cast<uint8_t>(buffer >> 16);
+            op[3] = static_cast<uint8_t>(buffer >> 24);
+            op += 4;
+            buffer >>= 32;
+            count -= 32;
+        }
+    }
+    while (count > 0) {
+        *op++ = static_cast<uint8_t>(buffer);
+        buffer >>= 8;
+        count = count > 8 ? count - 8 : 0;
+    }
+    return static_cast<size_t>(op - out);
+}
+
+bool HuffmanCoder::decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    if (srcSize < LENGTHS_SIZE) {
+        return false;
+    }
+    uint8_t lengths[256];
+    uint32_t kraft = 0;
+    for (size_t i = 0; i < LENGTHS_SIZE; i++) {
+        lengths[2 * i] = src[i] & 15;
+        lengths[2 * i + 1] = src[i] >> 4;
+    }
+    for (unsigned s = 0; s < 256; s++) {
+        if (lengths[s] > BLOCK_CODE_BITS) {
+            return false;
+        }
+        if (lengths[s] != 0) {
+            kraft += 1u << (BLOCK_CODE_BITS - lengths[s]);
+        }
+    }
+    if (kraft > TABLE_SIZE) {
+        return false;
+    }
+
+    // One lookup of BLOCK_CODE_BITS bits yields the first code, and the
+    // second as well when both fit.
+    uint16_t codes[256];
+    assignCodes(lengths, 256, codes);
+    uint16_t single[TABLE_SIZE] = {0};
+    for (unsigned s = 0; s < 256; s++) {
+        if (lengths[s] != 0) {
+            for (size_t i = codes[s]; i < TABLE_SIZE; i += static_cast<size_t>(1) << lengths[s]) {
+                single[i] = singleEntry(s, lengths[s]);
+            }
+        }
+    }
+    uint32_t multi[TABLE_SIZE];
+    for (size_t i = 0; i < TABLE_SIZE; i++) {
+        unsigned first = single[i] >> 8;
+        if (first == 0) {
+            multi[i] = 0;
+            continue;
+        }
+        uint16_t next = single[i >> first];
+        unsigned second = next >> 8;
+        if (second != 0 && first + second <= BLOCK_CODE_BITS) {
+            multi[i] = multiEntry(single[i] & 255, next & 255, first + second, 2);
+        } else {
+            multi[i] = multiEntry(single[i] & 255, 0, first, 1);
+        }
+    }
+
+    const uint8_t* stream = src + LENGTHS_SIZE;
+    BitReader reader(stream, srcSize - LENGTHS_SIZE);
+    uint8_t* op = dst;
+    uint8_t* end = dst + dstSize;
+
+    // Four lookups use at most 44 of the 56 bits a refill guarantees and
+    // write at most 8 bytes.
+    while (end - op >= 8) {
+        reader.refill();
+        for (int k = 0; k < 4; k++) {
+            uint32_t entry = multi[reader.peek() & TABLE_MASK];
+            if (entry == 0) {
+                return false;
+            }
+            op[0] = static_cast<uint8_t>(entry);
+            op[1] = static_cast<uint8_t>(entry >> 8);
+            op += entry >> 20;
+            reader.consume((entry >> 16) & 15);
+        }
+    }
+    while (op < end) {
+        reader.refill();
+        uint16_t entry = single[reader.peek() & TABLE_MASK];
+        if (entry == 0) {
+            return false;
+        }
+        *op++ = static_cast<uint8_t>(entry);
+        reader.consume(entry >> 8);
+    }
+
+    return reader.bytesUsed(stream) == srcSize - LENGTHS_SIZE;
+}
@@ -0,0 +1,95 @@
+#ifndef HUFFMAN_CODER_H
+#define HUFFMAN_CODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file HuffmanCoder.h
+ * @brief Contains the HuffmanCoder class, canonical Huffman code construction and a byte coder
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * Encoded block format:
+ *
+ *   lengths[128]    code length of every byte value, one nibble each, the
+ *                   even value in the low nibble; 0 for unused values
+ *   bitstream       canonical codes, least significant bit first, padded
+ *                   with zero bits to a whole byte
+ *
+ * Codes are limited to BLOCK_CODE_BITS bits so that a single table lookup
+ * resolves one code, and usually two.
+ */
+
+/**
+ * @brief Builds length-limited canonical Huffman codes and entropy codes bytes with them
+ *
+ * The code construction is shared with the Deflater; the block coder is a
+ * stateless byte coder for payloads whose decoded size is known.
+ */
+class HuffmanCoder {
+public:
+    /// Largest alphabet buildCodeLengths() accepts
+    static const unsigned MAX_SYMBOLS = 288;
+    /// Longest code assignCodes() accepts
+    static const unsigned MAX_CODE_LENGTH = 15;
+    /// Longest code of the byte coder, and the width of its decode tables
+    static const unsigned BLOCK_CODE_BITS = 11;
+    /// Size of the code length table at the start of an encoded block
+    static const size_t LENGTHS_SIZE = 128;
+
+    /**
+     * @brief Computes length-limited Huffman code lengths
+     * @param freq Frequency of every symbol
+     * @param numSyms Number of symbols, at most MAX_SYMBOLS
+     * @param maxBits Longest allowed code
+     * @param lengths Receives the code length of every symbol, 0 for unused ones
+     */
+    static void buildCodeLengths(const uint32_t* freq, unsigned numSyms, unsigned maxBits, uint8_t* lengths);
+
+    /**
+     * @brief Assigns canonical codes to code lengths, bit-reversed for LSB-first output
+     * @param lengths Code length of every symbol, at most MAX_CODE_LENGTH
+     * @param numSyms Number of symbols
+     * @param codes Receives the code of every symbol
+     */
+    static void assignCodes(const uint8_t* lengths, unsigned numSyms, uint16_t* codes);
+
+    /**
+     * @brief Reverses the order of the low length bits of code
+     */
+    static unsigned reverseBits(unsigned code, unsigned length);
+
+    /**
+     * @brief Returns the worst-case encoded size of size input bytes
+     */
+    static size_t maxEncodedSize(size_t size) { return LENGTHS_SIZE + (size * BLOCK_CODE_BITS + 7) / 8 + 8; }
+
+    /**
+     * @brief Returns the largest decoded size a block of size bytes can have, one symbol per code bit
+     */
+    static uint64_t maxDecodedSize(size_t size) {
+        return size < LENGTHS_SIZE ? 0 : static_cast<uint64_t>(size - LENGTHS_SIZE) * 8;
+    }
+
+    /**
+     * @brief Entropy codes a buffer into caller-provided memory
+     * @param data Input bytes
+     * @param size Number of input bytes
+     * @param out Output buffer of at least maxEncodedSize(size) bytes
+     * @return Number of bytes written
+     */
+    static size_t encode(const uint8_t* data, size_t size, uint8_t* out);
+
+    /**
+     * @brief Decodes a block whose decoded size is known in advance
+     * @param src Encoded bytes
+     * @param srcSize Number of encoded bytes
+     * @param dst Output buffer
+     * @param dstSize Exact decoded size
+     * @return true if the block is well formed and decodes to exactly dstSize bytes
+     */
+    static bool decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+};
+
+#endif // HUFFMAN_CODER_H
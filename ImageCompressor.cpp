@@ -1,9 +1,22 @@
 #include "ImageCompressor.h"
+#include "MappedFile.h"
+#include "RandomAccessFile.h"
+#include "RLECodec.h"
+#include "LZCodec.h"
+#include "HuffmanCoder.h"
+#include "RANSCoder.h"
+#include "PixelPredictor.h"
+#include "CRC32.h"
+#include "BufferPool.h"
+#include "Console.h"
+#include "Stats.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 
 /**
  * @file ImageCompressor.cpp
@@ -12,185 +25,1229 @@
  * @date 2025
  */
 
+namespace {
+
+// Run-length codec of the .samet payloads: runs and literals of up to 255
+// bytes, within independent 1024-byte blocks.
+typedef RLECodec<255, 255, ImageCompressor::BLOCK_SIZE> SametRLE;
+
+// Header line of a version 1 file: width, height, channels and the size of
+// the pixel data, followed by the payload size when it is run-length coded.
+struct Version1Header {
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;
+    uint64_t dataSize;
+    uint64_t compressedSize;
+    bool runLength;
+    uint64_t rawSize;       // width * height * channels
+};
+
+bool parseVersion1Header(const std::string& line, Version1Header& header, std::string& error) {
+    std::istringstream iss(line);
+    long long width, height, channels;
+    unsigned long long dataSize, compressedSize;
+    if (!(iss >> width >> height >> channels >> dataSize)) {
+        error = "Failed to parse header values";
+        return false;
+    }
+    if (width <= 0 || height <= 0 || channels <= 0 || channels > 4 ||
+        width > UINT32_MAX || height > UINT32_MAX) {
+        error = "Invalid image dimensions in header";
+        return false;
+    }
+
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.channels = static_cast<uint8_t>(channels);
+    header.dataSize = dataSize;
+    header.runLength = static_cast<bool>(iss >> compressedSize);
+    header.compressedSize = header.runLength ? compressedSize : 0;
+    // At most 2^32 * 2^32 pixels of 4 bytes would overflow; such a file
+    // cannot exist, so the product is simply capped.
+    uint64_t pixels = static_cast<uint64_t>(header.width) * header.height;
+    header.rawSize = pixels > UINT64_MAX / header.channels ? UINT64_MAX : pixels * header.channels;
+    return true;
+}
+
+// Tells whether data starts with a zlib header using deflate.
+bool hasZlibHeader(const uint8_t* data, size_t size) {
+    return size >= 2 && (data[0] & 0x0F) == 8 && (data[0] >> 4) <= 7 &&
+           ((static_cast<unsigned>(data[0]) << 8) | data[1]) % 31 == 0;
+}
+
+inline void writeLE32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline uint32_t readLE32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Settings every block of a file is encoded with
+struct BlockSettings {
+    SametCodec codec;
+    size_t window;
+    SametEntropy entropy;
+    CodecPolicy policy;
+    double storageSpeed;    // bytes per microsecond
+    double sizeBudget;
+};
+
+// Runs a codec over a block; RAW leaves out empty.
+void runCodec(SametCodec codec, size_t window, const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    switch (codec) {
+        case SametCodec::RAW:
+            out.clear();
+            break;
+        case SametCodec::RLE:
+            out.resize(SametRLE::maxEncodedSize(size));
+            out.resize(SametRLE::encode(data, size, out.data()));
+            break;
+        case SametCodec::LZ: {
+            // The match finder's tables are reused by every block a thread encodes.
+            thread_local LZCodec encoder;
+            encoder.setWindow(window);
+            out.resize(LZCodec::maxCompressedSize(size));
+            out.resize(encoder.compress(data, size, out.data()));
+            break;
+        }
+    }
+}
+
+// Entropy codes bytes behind a u32 holding their number.
+void runEntropy(SametEntropy entropy, const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    switch (entropy) {
+        case SametEntropy::NONE:
+            out.assign(data, data + size);
+            return;
+        case SametEntropy::HUFFMAN:
+            out.resize(4 + HuffmanCoder::maxEncodedSize(size));
+            out.resize(4 + HuffmanCoder::encode(data, size, out.data() + 4));
+            break;
+        case SametEntropy::RANS:
+            out.resize(4 + RANSCoder::maxEncodedSize(size));
+            out.resize(4 + RANSCoder::encode(data, size, out.data() + 4));
+            break;
+    }
+    writeLE32(out.data(), static_cast<uint32_t>(size));
+}
+
+// Runs the entropy coder over a block's codec output, keeping the result
+// only if it is smaller.
+void entropyCode(SametEntropy entropy, std::vector<uint8_t>& out, SametBlockEntry& entry) {
+    if (entropy == SametEntropy::NONE) {
+        return;
+    }
+    std::vector<uint8_t> coded;
+    runEntropy(entropy, out.data(), out.size(), coded);
+    if (coded.size() < out.size()) {
+        out.swap(coded);
+        entry.entropy = entropy;
+    }
+}
+
+// Single-core decode cost model, in bytes per microsecond, fitted on flat,
+// smooth and noisy synthetic images. A codec pays for writing the whole
+// block and for parsing its own output; an entropy coder for every symbol
+// it produces, that is for every byte of the codec output.
+double codecDecodeTime(SametCodec codec, double rawSize, double codedSize) {
+    switch (codec) {
+        case SametCodec::RAW: return rawSize / 8000.0;
+        case SametCodec::RLE: return rawSize / 6000.0 + codedSize / 2500.0;
+        case SametCodec::LZ: return rawSize / 12000.0 + codedSize / 700.0;
+    }
+    return rawSize;
+}
+
+double entropyDecodeTime(SametEntropy entropy, double symbols) {
+    switch (entropy) {
+        case SametEntropy::NONE: return 0.0;
+        case SametEntropy::HUFFMAN: return symbols / 350.0;
+        case SametEntropy::RANS: return symbols / 300.0;
+    }
+    return symbols;
+}
+
+// Estimated outcome of one codec and entropy coder on a block
+struct Candidate {
+    SametCodec codec;
+    SametEntropy entropy;
+    double size;
+    double decodeTime;      // microseconds
+};
+
+// Copies SAMPLE_SLICES evenly spaced slices of a block, aligned to the
+// run-length blocks, or returns the block itself when it is small.
+const uint8_t* sampleBlock(const uint8_t* data, size_t size, std::vector<uint8_t>& sample, size_t& sampleSize) {
+    const size_t slices = ImageCompressor::SAMPLE_SLICES;
+    const size_t sliceSize = ImageCompressor::SAMPLE_SLICE_SIZE;
+    if (size <= 2 * slices * sliceSize) {
+        sampleSize = size;
+        return data;
+    }
+    sample.resize(slices * sliceSize);
+    for (size_t k = 0; k < slices; k++) {
+        size_t offset = k * (size - sliceSize) / (slices - 1);
+        offset -= offset % ImageCompressor::BLOCK_SIZE;
+        std::memcpy(sample.data() + k * sliceSize, data + offset, sliceSize);
+    }
+    sampleSize = sample.size();
+    return sample.data();
+}
+
+// Trial compresses a sample of the block with every codec and entropy coder
+// and picks one according to the policy. Estimates scale linearly from the
+// sample; decode times come from the cost model rather than from timing,
+// so the choice, and the file, are reproducible.
+void chooseCoding(const BlockSettings& settings, const uint8_t* data, size_t size,
+                  SametCodec& codec, SametEntropy& entropy) {
+    thread_local std::vector<uint8_t> sample;
+    thread_local std::vector<uint8_t> codecOut;
+    thread_local std::vector<uint8_t> entropyOut;
+    size_t sampleSize = 0;
+    const uint8_t* sampled = sampleBlock(data, size, sample, sampleSize);
+    double scale = sampleSize ? static_cast<double>(size) / sampleSize : 0.0;
+
+    static const SametCodec codecs[] = {SametCodec::RAW, SametCodec::RLE, SametCodec::LZ};
+    static const SametEntropy coders[] = {SametEntropy::NONE, SametEntropy::HUFFMAN, SametEntropy::RANS};
+    Candidate candidates[9];
+    size_t count = 0;
+    for (SametCodec c : codecs) {
+        runCodec(c, settings.window, sampled, sampleSize, codecOut);
+        const uint8_t* stage = c == SametCodec::RAW ? sampled : codecOut.data();
+        size_t stageSize = c == SametCodec::RAW ? sampleSize : codecOut.size();
+        // The block would be stored raw anyway.
+        if (c != SametCodec::RAW && stageSize >= sampleSize) {
+            continue;
+        }
+        for (SametEntropy e : coders) {
+            size_t coded = stageSize;
+            if (e != SametEntropy::NONE) {
+                runEntropy(e, stage, stageSize, entropyOut);
+                if (entropyOut.size() >= stageSize) {
+                    continue;
+                }
+                coded = entropyOut.size();
+            }
+            Candidate& candidate = candidates[count++];
+            candidate.codec = c;
+            candidate.entropy = e;
+            candidate.size = coded * scale;
+            candidate.decodeTime = codecDecodeTime(c, static_cast<double>(size), stageSize * scale) +
+                                   entropyDecodeTime(e, stageSize * scale);
+        }
+    }
+
+    // Ties go to the earlier, simpler candidate.
+    size_t smallest = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (candidates[i].size < candidates[smallest].size) {
+            smallest = i;
+        }
+    }
+    size_t best = smallest;
+    switch (settings.policy) {
+        case CodecPolicy::FIXED:
+        case CodecPolicy::MAX_RATIO:
+            break;
+        case CodecPolicy::MAX_SPEED: {
+            // Time to read the block from storage and decode it.
+            auto loadTime = [&](const Candidate& candidate) {
+                return candidate.size / settings.storageSpeed + candidate.decodeTime;
+            };
+            for (size_t i = 0; i < count; i++) {
+                if (loadTime(candidates[i]) < loadTime(candidates[best])) {
+                    best = i;
+                }
+            }
+            break;
+        }
+        case CodecPolicy::BUDGET: {
+            double limit = candidates[smallest].size * (1.0 + settings.sizeBudget);
+            for (size_t i = 0; i < count; i++) {
+                if (candidates[i].size <= limit && candidates[i].decodeTime < candidates[best].decodeTime) {
+                    best = i;
+                }
+            }
+            break;
+        }
+    }
+    codec = candidates[best].codec;
+    entropy = candidates[best].entropy;
+}
+
+// Compresses one container block and fills in everything of its index entry
+// except the offsets. The codec and entropy coder are the configured ones or
+// those the policy picks for the block. A block the codec does not shrink is
+// stored raw, and entropy coded on its own.
+void compressBlock(const BlockSettings& settings, const uint8_t* data, size_t size,
+                   std::vector<uint8_t>& out, SametBlockEntry& entry) {
+    SametCodec codec = settings.codec;
+    SametEntropy entropy = settings.entropy;
+    if (settings.policy != CodecPolicy::FIXED) {
+        chooseCoding(settings, data, size, codec, entropy);
+    }
+    runCodec(codec, settings.window, data, size, out);
+    entry.codec = codec;
+    if (codec == SametCodec::RAW || out.size() >= size) {
+        out.assign(data, data + size);
+        entry.codec = SametCodec::RAW;
+    }
+    entry.entropy = SametEntropy::NONE;
+    entropyCode(entropy, out, entry);
+    entry.predictor = SametPredictor::NONE;
+    entry.color = SametColorTransform::NONE;
+    entry.rawSize = static_cast<uint32_t>(size);
+    entry.compressedSize = static_cast<uint32_t>(out.size());
+    entry.checksum = CRC32::update(0, data, size);
+}
+
+void encodeBlock(const BlockSettings& settings, const uint8_t* data, size_t size,
+                 std::vector<uint8_t>& out, SametBlockEntry& entry) {
+    ScopedTimer timer(Stage::BLOCK_ENCODE);
+    compressBlock(settings, data, size, out, entry);
+    timer.setBytes(size, out.size());
+    Stats::add(Counter::BLOCKS_ENCODED);
+}
+
+// Pixel size the predictor works with; pixels smaller than a byte count as one.
+size_t predictorPixelBytes(const SametHeader& header) {
+    return std::max<size_t>(1, header.channels * header.bitDepth / 8);
+}
+
+// CRC-32 of rows of rowLength bytes, stride bytes apart, as if they were contiguous.
+uint32_t rowsCRC(const uint8_t* rows, size_t stride, size_t rowLength, size_t count) {
+    uint32_t crc = 0;
+    for (size_t r = 0; r < count; r++) {
+        crc = CRC32::update(crc, rows + r * stride, rowLength);
+    }
+    return crc;
+}
+
+// Predicts a block of rows straight from the image and compresses the
+// residuals. The checksum still covers the pixels, so that it verifies the
+// reconstruction too.
+void encodeRows(const BlockSettings& settings, SametPredictor predictor, SametColorTransform color,
+                size_t bytesPerPixel, const uint8_t* rows, size_t stride, size_t rowLength, size_t count,
+                std::vector<uint8_t>& out, SametBlockEntry& entry) {
+    ScopedTimer timer(Stage::BLOCK_ENCODE);
+    thread_local std::vector<uint8_t> residuals;
+    residuals.resize(rowLength * count);
+    PixelPredictor::predict(predictor, color, rows, stride, rowLength, count, bytesPerPixel, residuals.data());
+    compressBlock(settings, residuals.data(), residuals.size(), out, entry);
+    entry.predictor = predictor;
+    entry.color = color;
+    entry.checksum = rowsCRC(rows, stride, rowLength, count);
+    timer.setBytes(residuals.size(), out.size());
+    Stats::add(Counter::BLOCKS_ENCODED);
+}
+
+bool decodeBlock(SametCodec codec, SametEntropy entropy, const uint8_t* src, size_t srcSize,
+                 uint8_t* dst, size_t dstSize) {
+    if (entropy != SametEntropy::NONE) {
+        if (srcSize < 4) {
+            return false;
+        }
+        // The codec output is entropy decoded aside, or straight into place
+        // for a raw block. Stored codec output is always smaller than the block.
+        size_t symbols = readLE32(src);
+        thread_local std::vector<uint8_t> scratch;
+        uint8_t* target = dst;
+        if (codec == SametCodec::RAW) {
+            if (symbols != dstSize) {
+                return false;
+            }
+        } else {
+            if (symbols >= dstSize) {
+                return false;
+            }
+            scratch.resize(symbols);
+            target = scratch.data();
+        }
+        bool decoded = false;
+        switch (entropy) {
+            case SametEntropy::NONE:
+                break;
+            case SametEntropy::HUFFMAN:
+                decoded = HuffmanCoder::decode(src + 4, srcSize - 4, target, symbols);
+                break;
+            case SametEntropy::RANS:
+                decoded = RANSCoder::decode(src + 4, srcSize - 4, target, symbols);
+                break;
+        }
+        if (!decoded || codec == SametCodec::RAW) {
+            return decoded;
+        }
+        src = scratch.data();
+        srcSize = symbols;
+    }
+
+    switch (codec) {
+        case SametCodec::RAW:
+            if (srcSize != dstSize) {
+                return false;
+            }
+            std::memcpy(dst, src, dstSize);
+            return true;
+        case SametCodec::RLE:
+            return SametRLE::decode(src, srcSize, dst, dstSize);
+        case SametCodec::LZ:
+            return LZCodec::decompress(src, srcSize, dst, dstSize);
+    }
+    return false;
+}
+
+// Turns a decoded block of rows into pixels at out, rows outStride bytes
+// apart, and checks them against the block's CRC. Predicted blocks are
+// reconstructed and color inverted on the way; out may be the block itself.
+bool restoreRows(const SametBlockEntry& entry, size_t bytesPerPixel, uint8_t* block,
+                 size_t rowLength, size_t count, uint8_t* out, size_t outStride) {
+    if (entry.predictor != SametPredictor::NONE || entry.color != SametColorTransform::NONE) {
+        if (!PixelPredictor::reconstruct(entry.predictor, entry.color, block, rowLength, count,
+                                         bytesPerPixel, out, outStride)) {
+            return false;
+        }
+    } else if (out != block) {
+        for (size_t r = 0; r < count; r++) {
+            std::memcpy(out + r * outStride, block + r * rowLength, rowLength);
+        }
+    }
+    return rowsCRC(out, outStride, rowLength, count) == entry.checksum;
+}
+
+// Pixel rectangle covered by a tile
+struct TileRect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+TileRect tileRect(const SametHeader& header, size_t tile) {
+    uint32_t across = header.tilesAcross();
+    TileRect rect;
+    rect.x = static_cast<uint32_t>(tile % across) * header.tileSize;
+    rect.y = static_cast<uint32_t>(tile / across) * header.tileSize;
+    rect.width = std::min<uint32_t>(header.tileSize, header.width - rect.x);
+    rect.height = std::min<uint32_t>(header.tileSize, header.height - rect.y);
+    return rect;
+}
+
+// Largest block the payload of an entry can decode to, from the expansion
+// limit of its entropy coder and codec.
+uint64_t maxBlockSize(const SametBlockEntry& entry) {
+    uint64_t symbols = entry.compressedSize;
+    size_t coded = entry.compressedSize < 4 ? 0 : entry.compressedSize - 4;
+    switch (entry.entropy) {
+        case SametEntropy::NONE: break;
+        case SametEntropy::HUFFMAN: symbols = HuffmanCoder::maxDecodedSize(coded); break;
+        case SametEntropy::RANS: symbols = RANSCoder::maxDecodedSize(coded); break;
+    }
+    switch (entry.codec) {
+        case SametCodec::RAW: return symbols;
+        case SametCodec::RLE: return SametRLE::maxDecodedSize(static_cast<size_t>(symbols));
+        case SametCodec::LZ: return LZCodec::maxDecodedSize(static_cast<size_t>(symbols));
+    }
+    return 0;
+}
+
+// Checks the CRC of a serialized index and parses it. The blocks must cover
+// the pixel data in order, stay inside the payload area, which the caller has
+// checked lies inside the file, claim no more pixels than their payload can
+// decode to and, for a tiled file, match the tile geometry. That makes
+// decoding them independently safe and keeps a small file from reserving
+// memory it cannot fill.
+bool parseIndex(const SametHeader& header, const uint8_t* table, std::vector<SametBlockEntry>& index,
+                std::string& error) {
+    size_t tableSize = static_cast<size_t>(header.blockCount) * SametBlockEntry::SIZE;
+    uint32_t storedCRC = 0;
+    for (int i = 3; i >= 0; i--) {
+        storedCRC = (storedCRC << 8) | table[tableSize + i];
+    }
+    if (CRC32::update(0, table, tableSize) != storedCRC) {
+        error = "CRC mismatch in block index";
+        return false;
+    }
+
+    size_t pixelBytes = (static_cast<size_t>(header.channels) * header.bitDepth) / 8;
+    if (header.tileSize != 0 &&
+        (pixelBytes == 0 || (header.channels * header.bitDepth) % 8 != 0 ||
+         static_cast<uint64_t>(header.tilesAcross()) * header.tilesDown() != header.blockCount)) {
+        error = "Tile layout does not match the image dimensions";
+        return false;
+    }
+
+    index.resize(header.blockCount);
+    uint64_t expectedOffset = 0;
+    for (size_t i = 0; i < index.size(); i++) {
+        index[i].parse(table + i * SametBlockEntry::SIZE);
+        const SametBlockEntry& entry = index[i];
+        bool tileMismatch = false;
+        if (header.tileSize != 0) {
+            TileRect rect = tileRect(header, i);
+            tileMismatch = entry.rawSize != static_cast<uint64_t>(rect.width) * pixelBytes * rect.height;
+        }
+        // Predicted linear blocks must hold whole rows.
+        bool rowMismatch = header.tileSize == 0 &&
+            (entry.predictor != SametPredictor::NONE || entry.color != SametColorTransform::NONE) &&
+            (header.rowBytes() == 0 || entry.rawOffset % header.rowBytes() != 0 ||
+             entry.rawSize % header.rowBytes() != 0);
+        if (entry.rawOffset != expectedOffset || tileMismatch || rowMismatch ||
+            entry.compressedOffset < SametHeader::SIZE ||
+            entry.compressedOffset > header.indexOffset ||
+            entry.compressedSize > header.indexOffset - entry.compressedOffset ||
+            entry.rawSize > maxBlockSize(entry)) {
+            error = "Corrupt entry for block " + std::to_string(i);
+            return false;
+        }
+        expectedOffset += entry.rawSize;
+    }
+
+    if (expectedOffset != header.rawSize || header.rawSize != header.rowBytes() * header.height) {
+        error = "Block sizes do not match the image dimensions";
+        return false;
+    }
+    return true;
+}
+
+// Remembers the lowest failing block index across threads.
+void recordFailure(std::atomic<size_t>& firstBad, size_t block) {
+    size_t current = firstBad.load();
+    while (block < current && !firstBad.compare_exchange_weak(current, block)) {
+    }
+}
+
+} // namespace
+
+const size_t ImageCompressor::BLOCK_SIZE;
+const size_t ImageCompressor::DEFAULT_BLOCKS_PER_GROUP;
+const size_t ImageCompressor::MAX_BLOCKS_PER_GROUP;
+const size_t ImageCompressor::MIN_STREAM_SEGMENT;
+const size_t ImageCompressor::SAMPLE_SLICES;
+const size_t ImageCompressor::SAMPLE_SLICE_SIZE;
+
+ImageCompressor::ImageCompressor(ThreadPool* pool)
+    : pool(pool ? pool : &ThreadPool::shared()), blocksPerGroup(DEFAULT_BLOCKS_PER_GROUP), tileSize(0),
+      codec(SametCodec::RLE), lzWindow(LZCodec::MAX_WINDOW), entropy(SametEntropy::NONE),
+      predictor(SametPredictor::NONE), colorTransform(true), policy(CodecPolicy::FIXED),
+      storageSpeed(500.0), sizeBudget(0.05) {}
+
 bool ImageCompressor::saveCompressed(const PNGImage& image, const std::string& filename) {
-    if (image.getWidth() == 0 || image.getHeight() == 0) {
-        std::cout << "Error: No image data to compress" << std::endl;
+    return saveCompressed(image.getPixels(), image.getWidth(), image.getHeight(),
+                          image.getChannels(), image.bitDepth, filename);
+}
+
+bool ImageCompressor::saveCompressed(ByteSpan pixels, uint32_t width, uint32_t height,
+                                     uint8_t channels, uint8_t bitDepth, const std::string& filename) {
+    error.clear();
+    if (width == 0 || height == 0) {
+        return fail("No image data to compress");
+    }
+
+    CONSOLE_INFO("Starting compression..." << std::endl);
+    CONSOLE_INFO("Image size: " << width << "x" << height 
+                 << " with " << (int)channels << " channels" << std::endl);
+
+    std::ofstream file(filename + ".samet", std::ios::binary);
+    if (!file.is_open()) {
+        return fail("Cannot create compressed file");
+    }
+
+    if (!writeCompressed(pixels, width, height, channels, bitDepth, file)) {
         return false;
     }
 
-    std::cout << "Starting compression..." << std::endl;
-    std::cout << "Image size: " << image.getWidth() << "x" << image.getHeight() 
-              << " with " << (int)image.getChannels() << " channels" << std::endl;
+    CONSOLE_INFO("Compression completed!" << std::endl);
+    CONSOLE_INFO("Original PNG data size: " << pixels.size << " bytes" << std::endl);
+
+    return true;
+}
+
+bool ImageCompressor::writeCompressed(ByteSpan pixels, uint32_t width, uint32_t height,
+                                      uint8_t channels, uint8_t bitDepth, std::ostream& out) {
+    error.clear();
+    if (width == 0 || height == 0) {
+        return fail("No image data to compress");
+    }
+
+    ScopedTimer timer(Stage::SAMET_ENCODE);
+    SametHeader header = makeHeader(width, height, channels, bitDepth, pixels.size);
+
+    std::vector<SametBlockEntry> index;
+    uint64_t fileOffset = SametHeader::SIZE;
+    out.write(std::string(SametHeader::SIZE, '\0').data(), SametHeader::SIZE);
+    if (header.tileSize != 0) {
+        writeTiles(out, header, pixels.data, header.height, fileOffset, index);
+    } else {
+        writeBlocks(out, header, pixels.data, pixels.size, fileOffset, index);
+    }
+
+    timer.setBytes(pixels.size, fileOffset + index.size() * SametBlockEntry::SIZE + 4);
+    return finishFile(out, header, index, fileOffset);
+}
+
+bool ImageCompressor::saveCompressed(PNGRowReader& reader, const std::string& filename) {
+    error.clear();
+    if (reader.getWidth() == 0 || reader.getHeight() == 0) {
+        return fail("No image data to compress");
+    }
+
+    CONSOLE_INFO("Starting streaming compression..." << std::endl);
+    CONSOLE_INFO("Image size: " << reader.getWidth() << "x" << reader.getHeight() 
+                 << " with " << (int)reader.getChannels() << " channels" << std::endl);
 
     std::ofstream file(filename + ".samet", std::ios::binary);
     if (!file.is_open()) {
-        std::cout << "Error: Cannot create compressed file" << std::endl;
+        return fail("Cannot create compressed file");
+    }
+
+    ScopedTimer timer(Stage::SAMET_ENCODE);
+    size_t dataSize = reader.getRowBytes() * reader.getHeight();
+    SametHeader header = makeHeader(reader.getWidth(), reader.getHeight(),
+                                    reader.getChannels(), reader.getBitDepth(), dataSize);
+
+    // The header is written last, once the index offset is known.
+    std::vector<SametBlockEntry> index;
+    uint64_t fileOffset = SametHeader::SIZE;
+    file.write(std::string(SametHeader::SIZE, '\0').data(), SametHeader::SIZE);
+
+    // Rows are gathered until every thread has a full group of blocks, or
+    // until a full row of tiles is available. A batch is a whole number of
+    // groups or tile rows, so the output matches the in-memory encoder byte
+    // for byte.
+    size_t stride = reader.getRowBytes();
+    size_t batchSize = header.tileSize != 0 ? stride * header.tileSize
+                                            : header.blockSize * (pool->getThreadCount() + 1);
+    std::vector<uint8_t> batch;
+    batch.reserve(batchSize);
+
+    auto flushBatch = [&]() {
+        if (header.tileSize != 0) {
+            writeTiles(file, header, batch.data(), static_cast<uint32_t>(batch.size() / stride),
+                       fileOffset, index);
+        } else {
+            writeBlocks(file, header, batch.data(), batch.size(), fileOffset, index);
+        }
+        batch.clear();
+    };
+
+    ByteSpan row;
+    while (reader.nextRow(row)) {
+        const uint8_t* rowData = row.data;
+        size_t remaining = row.size;
+        while (remaining > 0) {
+            size_t count = std::min(remaining, batchSize - batch.size());
+            batch.insert(batch.end(), rowData, rowData + count);
+            rowData += count;
+            remaining -= count;
+            if (batch.size() == batchSize) {
+                flushBatch();
+            }
+        }
+    }
+    if (!reader.finished()) {
+        return fail("Failed to decode row " + std::to_string(reader.getCurrentRow()) + ": " +
+                    reader.getError());
+    }
+    flushBatch();
+
+    timer.setBytes(dataSize, fileOffset + index.size() * SametBlockEntry::SIZE + 4);
+    if (!finishFile(file, header, index, fileOffset)) {
         return false;
     }
 
-    file << image.getWidth() << " " 
-         << image.getHeight() << " " 
-         << (int)image.getChannels() << " "
-         << image.getData().size() << "\n";
+    CONSOLE_INFO("Compression completed!" << std::endl);
+    CONSOLE_INFO("Original PNG data size: " << dataSize << " bytes" << std::endl);
 
-    const std::vector<uint8_t>& pngData = image.getData();
-    file.write(reinterpret_cast<const char*>(pngData.data()), pngData.size());
+    return true;
+}
 
-    file.close();
+SametHeader ImageCompressor::makeHeader(uint32_t width, uint32_t height, uint8_t channels,
+                                        uint8_t bitDepth, uint64_t rawSize) const {
+    SametHeader header;
+    header.version = SametHeader::VERSION;
+    header.codec = codec;
+    header.flags = 0;
+    header.width = width;
+    header.height = height;
+    header.channels = channels;
+    header.bitDepth = bitDepth;
+    // Tiles need whole bytes per pixel so that their columns can be cut out.
+    header.tileSize = (channels * bitDepth) % 8 == 0 ? tileSize : 0;
+    header.blockSize = header.tileSize != 0
+        ? static_cast<uint32_t>(header.tileSize) * header.tileSize * (channels * bitDepth / 8)
+        : static_cast<uint32_t>(BLOCK_SIZE * blocksPerGroup);
+    if (header.tileSize == 0 && predictorFor(header) != SametPredictor::NONE) {
+        // Predicted blocks are whole rows, as many as fit in a group.
+        size_t stride = header.rowBytes();
+        header.blockSize = static_cast<uint32_t>(std::max<size_t>(1, header.blockSize / stride) * stride);
+    }
+    header.blockCount = 0;
+    header.rawSize = rawSize;
+    header.indexOffset = 0;
+    return header;
+}
 
-    std::cout << "Compression completed!" << std::endl;
-    std::cout << "Original PNG data size: " << pngData.size() << " bytes" << std::endl;
+SametPredictor ImageCompressor::predictorFor(const SametHeader& header) const {
+    // A block must hold at least one row, so rows are limited to what an
+    // index entry can describe.
+    if (!PixelPredictor::supportsPixelSize(predictorPixelBytes(header)) ||
+        header.rowBytes() > UINT32_MAX / 2) {
+        return SametPredictor::NONE;
+    }
+    return predictor;
+}
+
+SametColorTransform ImageCompressor::colorTransformFor(const SametHeader& header) const {
+    return colorTransform && predictorFor(header) != SametPredictor::NONE &&
+           PixelPredictor::supportsColorTransform(header.channels, header.bitDepth)
+        ? SametColorTransform::YCOCG_R : SametColorTransform::NONE;
+}
+
+void ImageCompressor::writeBlocks(std::ostream& file, const SametHeader& header, const uint8_t* data,
+                                  size_t size, uint64_t& fileOffset, std::vector<SametBlockEntry>& index) {
+    size_t groupBytes = header.blockSize;
+    size_t groupCount = (size + groupBytes - 1) / groupBytes;
+    SametPredictor spatial = predictorFor(header);
+    SametColorTransform color = colorTransformFor(header);
+    size_t stride = header.rowBytes();
+    BlockSettings settings = {codec, lzWindow, entropy, policy, storageSpeed, sizeBudget};
+
+    // Every group is an independent block of the container, encoded into its
+    // own buffer; the buffers are written in order afterwards, so the result
+    // does not depend on the number of threads.
+    std::vector<std::vector<uint8_t> > groups(groupCount);
+    std::vector<SametBlockEntry> entries(groupCount);
+    pool->parallelFor(groupCount, 1, [&](size_t begin, size_t end) {
+        for (size_t g = begin; g < end; g++) {
+            size_t offset = g * groupBytes;
+            size_t length = std::min(groupBytes, size - offset);
+            if (spatial != SametPredictor::NONE) {
+                encodeRows(settings, spatial, color, predictorPixelBytes(header),
+                           data + offset, stride, stride, length / stride, groups[g], entries[g]);
+            } else {
+                encodeBlock(settings, data + offset, length, groups[g], entries[g]);
+            }
+        }
+    });
 
+    appendBlocks(file, groups, entries, fileOffset, index);
+}
+
+void ImageCompressor::writeTiles(std::ostream& file, const SametHeader& header, const uint8_t* rows,
+                                 uint32_t rowCount, uint64_t& fileOffset,
+                                 std::vector<SametBlockEntry>& index) {
+    size_t stride = header.rowBytes();
+    size_t pixelBytes = header.channels * header.bitDepth / 8;
+    uint32_t across = header.tilesAcross();
+    uint32_t bands = (rowCount + header.tileSize - 1) / header.tileSize;
+    size_t tileCount = static_cast<size_t>(across) * bands;
+    SametPredictor spatial = predictorFor(header);
+    SametColorTransform color = colorTransformFor(header);
+    BlockSettings settings = {codec, lzWindow, entropy, policy, storageSpeed, sizeBudget};
+
+    std::vector<std::vector<uint8_t> > tiles(tileCount);
+    std::vector<SametBlockEntry> entries(tileCount);
+    pool->parallelFor(tileCount, 1, [&](size_t begin, size_t end) {
+        std::vector<uint8_t> scratch;
+        for (size_t t = begin; t < end; t++) {
+            // Coordinates are relative to the band, which starts on a tile row.
+            uint32_t x = static_cast<uint32_t>(t % across) * header.tileSize;
+            uint32_t y = static_cast<uint32_t>(t / across) * header.tileSize;
+            uint32_t width = std::min<uint32_t>(header.tileSize, header.width - x);
+            uint32_t height = std::min<uint32_t>(header.tileSize, rowCount - y);
+            size_t tileStride = width * pixelBytes;
+            const uint8_t* origin = rows + y * stride + x * pixelBytes;
+
+            // Predicted tiles are read in place; the others are gathered first.
+            if (spatial != SametPredictor::NONE) {
+                encodeRows(settings, spatial, color, pixelBytes,
+                           origin, stride, tileStride, height, tiles[t], entries[t]);
+                continue;
+            }
+            scratch.resize(tileStride * height);
+            for (uint32_t r = 0; r < height; r++) {
+                std::memcpy(scratch.data() + r * tileStride, origin + r * stride, tileStride);
+            }
+            encodeBlock(settings, scratch.data(), scratch.size(), tiles[t], entries[t]);
+        }
+    });
+
+    appendBlocks(file, tiles, entries, fileOffset, index);
+}
+
+void ImageCompressor::appendBlocks(std::ostream& file, const std::vector<std::vector<uint8_t> >& blocks,
+                                   std::vector<SametBlockEntry>& entries, uint64_t& fileOffset,
+                                   std::vector<SametBlockEntry>& index) {
+    uint64_t rawOffset = index.empty() ? 0 : index.back().rawOffset + index.back().rawSize;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        entries[i].rawOffset = rawOffset;
+        entries[i].compressedOffset = fileOffset;
+        file.write(reinterpret_cast<const char*>(blocks[i].data()), blocks[i].size());
+        rawOffset += entries[i].rawSize;
+        fileOffset += blocks[i].size();
+        index.push_back(entries[i]);
+    }
+}
+
+bool ImageCompressor::finishFile(std::ostream& file, SametHeader& header,
+                                 const std::vector<SametBlockEntry>& index, uint64_t fileOffset) {
+    std::vector<uint8_t> table(index.size() * SametBlockEntry::SIZE + 4);
+    for (size_t i = 0; i < index.size(); i++) {
+        index[i].serialize(table.data() + i * SametBlockEntry::SIZE);
+    }
+    uint32_t crc = CRC32::update(0, table.data(), table.size() - 4);
+    for (int i = 0; i < 4; i++) {
+        table[table.size() - 4 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+    file.write(reinterpret_cast<const char*>(table.data()), table.size());
+
+    header.blockCount = static_cast<uint32_t>(index.size());
+    header.indexOffset = fileOffset;
+    uint8_t bytes[SametHeader::SIZE];
+    header.serialize(bytes);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(bytes), SametHeader::SIZE);
+
+    file.flush();
+    if (file.fail()) {
+        return fail("Failed to write compressed file");
+    }
     return true;
 }
 
 bool ImageCompressor::loadCompressed(const std::string& filename, PNGImage& image) {
+    error.clear();
+    {
+        MappedFile mapped;
+        if (mapped.open(filename) && SametHeader::hasMagic(mapped.data(), mapped.size())) {
+            ByteSpan bytes = {mapped.data(), mapped.size()};
+            return loadVersion2(bytes, image);
+        }
+    }
+
+    // Version 1: a text header followed by raw or run-length coded pixels.
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
-        std::cout << "Error: Cannot open file" << std::endl;
-        return false;
+        return fail("Cannot open file " + filename);
     }
 
-    std::string header;
-    std::getline(file, header);
-    
-    std::istringstream iss(header);
-    int width, height, channels;
-    size_t dataSize;
-    
-    if (!(iss >> width >> height >> channels >> dataSize)) {
-        std::cout << "Error: Failed to parse header values" << std::endl;
-        return false;
+    std::string line;
+    std::getline(file, line);
+    Version1Header header;
+    if (!parseVersion1Header(line, header, error)) {
+        return fail(error);
     }
+    uint32_t width = header.width;
+    uint32_t height = header.height;
+    int channels = header.channels;
+    uint64_t dataSize = header.dataSize;
+    uint64_t compressedSize = header.compressedSize;
+    bool runLength = header.runLength;
 
-    std::cout << "Image info from header:" << std::endl;
-    std::cout << "Width: " << width << std::endl;
-    std::cout << "Height: " << height << std::endl;
-    std::cout << "Channels: " << channels << std::endl;
-    std::cout << "Data size: " << dataSize << " bytes" << std::endl;
+    // Sizes from the header are checked against the file before anything is
+    // allocated for them.
+    std::streamoff start = file.tellg();
+    file.seekg(0, std::ios::end);
+    uint64_t remaining = static_cast<uint64_t>(file.tellg() - start);
+    file.seekg(start);
+
+    // Files written before readPNG inflated the image data hold the zlib
+    // stream of the IDAT chunks in place of the pixels.
+    bool zlibPayload = !runLength && dataSize != header.rawSize;
+    if ((runLength && (dataSize != header.rawSize || compressedSize > remaining)) ||
+        (!runLength && dataSize > remaining)) {
+        return fail("Header sizes do not match the file");
+    }
+
+    CONSOLE_INFO("Image info from header:" << std::endl);
+    CONSOLE_INFO("Width: " << width << std::endl);
+    CONSOLE_INFO("Height: " << height << std::endl);
+    CONSOLE_INFO("Channels: " << channels << std::endl);
+    CONSOLE_INFO("Data size: " << dataSize << " bytes" << std::endl);
 
     image.setWidth(width);
     image.setHeight(height);
     image.setChannels(channels);
+    image.setBitDepth(8);
 
-    std::vector<uint8_t> pngData(dataSize);
-    file.read(reinterpret_cast<char*>(pngData.data()), dataSize);
+    std::vector<uint8_t> pngData = BufferPool::shared().acquire(dataSize);
+    if (zlibPayload) {
+        file.read(reinterpret_cast<char*>(pngData.data()), dataSize);
+        ByteSpan stream = {pngData.data(), static_cast<size_t>(file.gcount())};
+        bool decoded = false;
+        if (stream.size != dataSize || !hasZlibHeader(stream.data, stream.size)) {
+            fail("Data size does not match the image dimensions");
+        } else {
+            CONSOLE_INFO("Decoding the image data of an early version 1 file" << std::endl);
+            decoded = image.decodeIDAT(stream, width, height, header.channels);
+            if (!decoded) {
+                error = image.getError();
+            }
+        }
+        BufferPool::shared().release(pngData);
+        return decoded;
+    } else if (runLength) {
+        std::vector<uint8_t> compressed(compressedSize);
+        file.read(reinterpret_cast<char*>(compressed.data()), compressedSize);
 
-    if (file.gcount() != dataSize) {
-        std::cout << "Error: Could not read all PNG data" << std::endl;
-        std::cout << "Expected: " << dataSize << " bytes" << std::endl;
-        std::cout << "Read: " << file.gcount() << " bytes" << std::endl;
-        return false;
+        if (static_cast<size_t>(file.gcount()) != compressedSize) {
+            fail("Could not read all compressed data");
+            std::cout << "Expected: " << compressedSize << " bytes" << std::endl;
+            std::cout << "Read: " << file.gcount() << " bytes" << std::endl;
+            return false;
+        }
+
+        // The header gives the decoded size, so the pixels are expanded
+        // straight into their final buffer, in parallel.
+        if (!decodeStream(compressed.data(), compressed.size(), pngData.data(), dataSize)) {
+            return fail("Compressed data is corrupt or does not match the header size");
+        }
+    } else {
+        file.read(reinterpret_cast<char*>(pngData.data()), dataSize);
+
+        if (static_cast<size_t>(file.gcount()) != dataSize) {
+            fail("Could not read all PNG data");
+            std::cout << "Expected: " << dataSize << " bytes" << std::endl;
+            std::cout << "Read: " << file.gcount() << " bytes" << std::endl;
+            return false;
+        }
     }
 
-    image.setData(pngData);
+    image.setData(std::move(pngData));
     
-    std::cout << "Decompression successful!" << std::endl;
-    std::cout << "Image dimensions: " << width << "x" << height << " with " 
-              << channels << " channels" << std::endl;
-    std::cout << "PNG data size: " << pngData.size() << " bytes" << std::endl;
+    CONSOLE_INFO("Decompression successful!" << std::endl);
+    CONSOLE_INFO("Image dimensions: " << width << "x" << height << " with " 
+                 << channels << " channels" << std::endl);
+    CONSOLE_INFO("PNG data size: " << image.data.size() << " bytes" << std::endl);
 
     return true;
 }
 
-std::string ImageCompressor::compressData(const std::vector<unsigned char>& data) {
-    std::string compressed;
-    size_t i = 0;
-    size_t totalSize = data.size();
-    size_t lastProgress = 0;
-    
-    compressed.reserve(data.size());
-    
-    while (i < data.size()) {
-        size_t progress = (i * 100) / totalSize;
-        if (progress > lastProgress) {
-            std::cout << "\rCompressing: " << progress << "%" << std::flush;
-            lastProgress = progress;
-        }
-
-        const size_t BLOCK_SIZE = 1024;
-        size_t remainingBytes = data.size() - i;
-        size_t blockSize = std::min(BLOCK_SIZE, remainingBytes);
-        
-        size_t j = 0;
-        while (j < blockSize) {
-            unsigned char currentByte = data[i + j];
-            size_t count = 1;
-            
-            while (j + count < blockSize && 
-                   count < 255 && 
-                   data[i + j + count] == currentByte) {
-                count++;
-            }
-            
-            if (count >= 4) {
-                compressed.push_back('\xFF');
-                compressed.push_back(currentByte);
-                compressed.push_back(static_cast<char>(count));
-                j += count;
+
+bool ImageCompressor::loadCompressed(ByteSpan file, PNGImage& image) {
+    error.clear();
+    if (!SametHeader::hasMagic(file.data, file.size)) {
+        return fail("Only version 2 files can be loaded from memory");
+    }
+    return loadVersion2(file, image);
+}
+
+bool ImageCompressor::readInfo(const std::string& filename, SametHeader& info) {
+    error.clear();
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return fail("Cannot open file " + filename);
+    }
+
+    uint8_t bytes[SametHeader::SIZE];
+    file.read(reinterpret_cast<char*>(bytes), SametHeader::SIZE);
+    size_t count = static_cast<size_t>(file.gcount());
+    if (SametHeader::hasMagic(bytes, count)) {
+        if (!info.parse(bytes, count)) {
+            return fail("Invalid or corrupt .samet header");
+        }
+        return true;
+    }
+
+    std::string line(reinterpret_cast<const char*>(bytes), count);
+    Version1Header header;
+    if (!parseVersion1Header(line.substr(0, line.find('\n')), header, error)) {
+        return fail(error);
+    }
+
+    info.version = 1;
+    info.codec = header.runLength ? SametCodec::RLE : SametCodec::RAW;
+    info.flags = 0;
+    info.width = header.width;
+    info.height = header.height;
+    info.channels = header.channels;
+    info.bitDepth = 8;
+    info.tileSize = 0;
+    info.blockSize = 0;
+    info.blockCount = 0;
+    info.rawSize = header.rawSize;
+    info.indexOffset = 0;
+    return true;
+}
+
+bool ImageCompressor::decodeStream(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    size_t segmentSize = std::max(MIN_STREAM_SEGMENT, srcSize / ((pool->getThreadCount() + 1) * 4));
+    if (srcSize <= segmentSize) {
+        return SametRLE::decode(src, srcSize, dst, dstSize);
+    }
+
+    std::vector<RLESegment> segments;
+    if (SametRLE::split(src, srcSize, segmentSize, segments) != dstSize) {
+        return false;
+    }
+
+    std::atomic<bool> ok(true);
+    pool->parallelFor(segments.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const RLESegment& segment = segments[i];
+            if (!SametRLE::decode(src + segment.srcOffset, segment.srcSize,
+                                  dst + segment.dstOffset, segment.dstSize)) {
+                ok.store(false);
+            }
+        }
+    });
+    return ok.load();
+}
+
+bool ImageCompressor::loadVersion2(ByteSpan file, PNGImage& image) {
+    ScopedTimer timer(Stage::SAMET_DECODE);
+    SametHeader header;
+    if (!header.parse(file.data, file.size)) {
+        return fail("Invalid or corrupt .samet header");
+    }
+
+    uint64_t indexSize = static_cast<uint64_t>(header.blockCount) * SametBlockEntry::SIZE + 4;
+    if (header.indexOffset < SametHeader::SIZE || header.indexOffset > file.size ||
+        indexSize > file.size - header.indexOffset) {
+        return fail("Block index lies outside the file");
+    }
+
+    std::vector<SametBlockEntry> index;
+    if (!parseIndex(header, file.data + header.indexOffset, index, error)) {
+        return fail(error);
+    }
+
+    image.setWidth(header.width);
+    image.setHeight(header.height);
+    image.setChannels(header.channels);
+    image.bitDepth = header.bitDepth;
+
+    CONSOLE_INFO("Image info from header:" << std::endl);
+    CONSOLE_INFO("Width: " << header.width << std::endl);
+    CONSOLE_INFO("Height: " << header.height << std::endl);
+    CONSOLE_INFO("Channels: " << (int)header.channels << std::endl);
+    CONSOLE_INFO("Data size: " << header.rawSize << " bytes" << std::endl);
+
+    image.allocateData(static_cast<size_t>(header.rawSize));
+    size_t stride = header.rowBytes();
+    size_t pixelBytes = header.channels * header.bitDepth / 8;
+    std::atomic<size_t> firstBad(index.size());
+    pool->parallelFor(index.size(), 1, [&](size_t begin, size_t end) {
+        std::vector<uint8_t> scratch;
+        for (size_t i = begin; i < end; i++) {
+            ScopedTimer blockTimer(Stage::BLOCK_DECODE);
+            const SametBlockEntry& entry = index[i];
+            // Linear blocks decode and reconstruct in place; tiles decode
+            // aside and are reconstructed or copied straight into their rows.
+            uint8_t* dst = image.data.data() + entry.rawOffset;
+            uint8_t* out = dst;
+            size_t rowLength = entry.rawSize;
+            size_t rows = 1;
+            size_t outStride = rowLength;
+            if (header.tileSize != 0) {
+                TileRect rect = tileRect(header, i);
+                scratch.resize(entry.rawSize);
+                dst = scratch.data();
+                out = image.data.data() + rect.y * stride + rect.x * pixelBytes;
+                rowLength = rect.width * pixelBytes;
+                rows = rect.height;
+                outStride = stride;
+            } else if (entry.predictor != SametPredictor::NONE || entry.color != SametColorTransform::NONE) {
+                rowLength = stride;
+                rows = entry.rawSize / stride;
+                outStride = stride;
+            }
+            if (!decodeBlock(entry.codec, entry.entropy, file.data + entry.compressedOffset,
+                             entry.compressedSize, dst, entry.rawSize) ||
+                !restoreRows(entry, predictorPixelBytes(header), dst, rowLength, rows, out, outStride)) {
+                recordFailure(firstBad, i);
             } else {
-                size_t literalCount = 1;
-                while (j + literalCount < blockSize && 
-                       literalCount < 255 && 
-                       (literalCount < 3 || 
-                        data[i + j + literalCount] != data[i + j + literalCount - 1] ||
-                        data[i + j + literalCount] != data[i + j + literalCount - 2])) {
-                    literalCount++;
+                blockTimer.setBytes(entry.compressedSize, entry.rawSize);
+                Stats::add(Counter::BLOCKS_DECODED);
+            }
+        }
+    });
+    if (firstBad.load() < index.size()) {
+        return fail("Block " + std::to_string(firstBad.load()) + " is corrupt");
+    }
+
+    timer.setBytes(file.size, header.rawSize);
+    CONSOLE_INFO("Decompression successful!" << std::endl);
+    CONSOLE_INFO("Image dimensions: " << header.width << "x" << header.height << " with " 
+                 << (int)header.channels << " channels" << std::endl);
+    CONSOLE_INFO("PNG data size: " << image.data.size() << " bytes" << std::endl);
+
+    return true;
+}
+
+bool ImageCompressor::loadRegion(const std::string& filename, uint32_t x, uint32_t y,
+                                 uint32_t width, uint32_t height, PNGImage& image) {
+    error.clear();
+    RandomAccessFile file;
+    if (!file.open(filename)) {
+        return fail("Cannot open file " + filename);
+    }
+
+    uint8_t headerBytes[SametHeader::SIZE];
+    size_t headerSize = static_cast<size_t>(std::min<uint64_t>(file.size(), SametHeader::SIZE));
+    if (!file.readAt(0, headerBytes, headerSize) || !SametHeader::hasMagic(headerBytes, headerSize)) {
+        // Version 1 files have no index: decode everything and crop.
+        file.close();
+        PNGImage full;
+        return loadCompressed(filename, full) && cropImage(full, x, y, width, height, image);
+    }
+
+    SametHeader header;
+    if (!header.parse(headerBytes, headerSize)) {
+        return fail("Invalid or corrupt .samet header");
+    }
+    if (width == 0 || height == 0 || x >= header.width || y >= header.height ||
+        width > header.width - x || height > header.height - y) {
+        return fail("Region lies outside the image");
+    }
+    if ((header.channels * header.bitDepth) % 8 != 0) {
+        return fail("Regions need whole bytes per pixel");
+    }
+
+    uint64_t indexSize = static_cast<uint64_t>(header.blockCount) * SametBlockEntry::SIZE + 4;
+    if (header.indexOffset < SametHeader::SIZE || header.indexOffset > file.size() ||
+        indexSize > file.size() - header.indexOffset) {
+        return fail("Block index lies outside the file");
+    }
+    std::vector<uint8_t> table(static_cast<size_t>(indexSize));
+    std::vector<SametBlockEntry> index;
+    if (!file.readAt(header.indexOffset, table.data(), table.size())) {
+        return fail("Cannot read the block index");
+    }
+    if (!parseIndex(header, table.data(), index, error)) {
+        return fail(error);
+    }
+
+    size_t stride = header.rowBytes();
+    size_t pixelBytes = header.channels * header.bitDepth / 8;
+    size_t outStride = width * pixelBytes;
+
+    // Blocks to fetch: the tiles overlapping the region, or the run of linear
+    // blocks holding its rows.
+    std::vector<size_t> blocks;
+    if (header.tileSize != 0) {
+        uint32_t across = header.tilesAcross();
+        for (uint32_t ty = y / header.tileSize; ty <= (y + height - 1) / header.tileSize; ty++) {
+            for (uint32_t tx = x / header.tileSize; tx <= (x + width - 1) / header.tileSize; tx++) {
+                blocks.push_back(static_cast<size_t>(ty) * across + tx);
+            }
+        }
+    } else {
+        uint64_t first = static_cast<uint64_t>(y) * stride;
+        uint64_t last = static_cast<uint64_t>(y + height) * stride;
+        for (size_t i = 0; i < index.size(); i++) {
+            if (index[i].rawOffset < last && index[i].rawOffset + index[i].rawSize > first) {
+                blocks.push_back(i);
+            }
+        }
+    }
+
+    image.setWidth(width);
+    image.setHeight(height);
+    image.setChannels(header.channels);
+    image.bitDepth = header.bitDepth;
+    image.allocateData(outStride * height);
+
+    std::atomic<size_t> firstBad(index.size());
+    pool->parallelFor(blocks.size(), 1, [&](size_t begin, size_t end) {
+        std::vector<uint8_t> compressed;
+        std::vector<uint8_t> pixels;
+        for (size_t b = begin; b < end; b++) {
+            ScopedTimer blockTimer(Stage::BLOCK_DECODE);
+            const SametBlockEntry& entry = index[blocks[b]];
+            compressed.resize(entry.compressedSize);
+            pixels.resize(entry.rawSize);
+            // Tiles and predicted linear blocks are whole rows, reconstructed in place.
+            size_t rowLength = entry.rawSize;
+            if (header.tileSize != 0) {
+                rowLength = tileRect(header, blocks[b]).width * pixelBytes;
+            } else if (entry.predictor != SametPredictor::NONE || entry.color != SametColorTransform::NONE) {
+                rowLength = stride;
+            }
+            if (!file.readAt(entry.compressedOffset, compressed.data(), compressed.size()) ||
+                !decodeBlock(entry.codec, entry.entropy, compressed.data(), compressed.size(),
+                             pixels.data(), pixels.size()) ||
+                !restoreRows(entry, predictorPixelBytes(header), pixels.data(), rowLength,
+                             pixels.size() / rowLength, pixels.data(), rowLength)) {
+                recordFailure(firstBad, blocks[b]);
+                continue;
+            }
+            blockTimer.setBytes(entry.compressedSize, entry.rawSize);
+            Stats::add(Counter::BLOCKS_DECODED);
+
+            if (header.tileSize != 0) {
+                TileRect rect = tileRect(header, blocks[b]);
+                uint32_t left = std::max(rect.x, x);
+                uint32_t right = std::min(rect.x + rect.width, x + width);
+                uint32_t top = std::max(rect.y, y);
+                uint32_t bottom = std::min(rect.y + rect.height, y + height);
+                for (uint32_t row = top; row < bottom; row++) {
+                    std::memcpy(image.data.data() + (row - y) * outStride + (left - x) * pixelBytes,
+                                pixels.data() + ((row - rect.y) * rect.width + (left - rect.x)) * pixelBytes,
+                                (right - left) * pixelBytes);
                 }
-                
-                compressed.push_back(static_cast<char>(literalCount - 1));
-                for (size_t k = 0; k < literalCount; k++) {
-                    compressed.push_back(static_cast<char>(data[i + j + k]));
+            } else {
+                // Copy the part of every region row that falls inside this
+                // block; rows may straddle block boundaries.
+                uint64_t blockStart = entry.rawOffset;
+                uint64_t blockEnd = blockStart + entry.rawSize;
+                for (uint32_t row = 0; row < height; row++) {
+                    uint64_t rowStart = static_cast<uint64_t>(y + row) * stride + x * pixelBytes;
+                    uint64_t start = std::max(rowStart, blockStart);
+                    uint64_t stop = std::min<uint64_t>(rowStart + outStride, blockEnd);
+                    if (start < stop) {
+                        std::memcpy(image.data.data() + row * outStride + (start - rowStart),
+                                    pixels.data() + (start - blockStart), static_cast<size_t>(stop - start));
+                    }
                 }
-                j += literalCount;
             }
         }
-        i += blockSize;
+    });
+    if (firstBad.load() < index.size()) {
+        return fail("Block " + std::to_string(firstBad.load()) + " is corrupt");
     }
-    
-    std::cout << "\rCompressing: 100%" << std::endl;
-    return compressed;
+
+    return true;
 }
 
-std::vector<unsigned char> ImageCompressor::decompressData(const std::string& compressed) {
-    std::vector<unsigned char> result;
-    size_t i = 0;
-    
-    std::cout << "Starting decompression..." << std::endl;
-    size_t totalSize = compressed.length();
-    size_t lastProgress = 0;
-    
-    result.reserve(totalSize * 2);
-    
-    while (i < compressed.length()) {
-        size_t progress = (i * 100) / totalSize;
-        if (progress > lastProgress) {
-            std::cout << "\rDecompressing: " << progress << "%" << std::flush;
-            lastProgress = progress;
-        }
-        
-        unsigned char control = static_cast<unsigned char>(compressed[i++]);
-        
-        if (control == 0xFF) {
-            if (i + 1 >= compressed.length()) break;
-            
-            unsigned char value = static_cast<unsigned char>(compressed[i++]);
-            unsigned char count = static_cast<unsigned char>(compressed[i++]);
-            
-            result.insert(result.end(), count, value);
-        } else {
-            unsigned char literalCount = control + 1;
-            if (i + literalCount > compressed.length()) break;
-            
-            result.insert(result.end(), 
-                         compressed.begin() + i, 
-                         compressed.begin() + i + literalCount);
-            i += literalCount;
-        }
+bool ImageCompressor::fail(const std::string& message) {
+    std::cout << "Error: " << message << std::endl;
+    // The first message names the cause; later ones come from the callers
+    // giving up in turn.
+    if (error.empty()) {
+        error = message;
     }
-    
-    std::cout << "\rDecompressing: 100%" << std::endl;
-    std::cout << "Decompressed size: " << result.size() << " bytes" << std::endl;
-    
-    return result;
-} 
\ No newline at end of file
+    return false;
+}
+
+bool ImageCompressor::cropImage(const PNGImage& source, uint32_t x, uint32_t y,
+                                uint32_t width, uint32_t height, PNGImage& image) {
+    size_t pixelBits = static_cast<size_t>(source.channels) * source.bitDepth;
+    if (width == 0 || height == 0 || x >= source.width || y >= source.height ||
+        width > source.width - x || height > source.height - y) {
+        return fail("Region lies outside the image");
+    }
+    if (pixelBits % 8 != 0) {
+        return fail("Regions need whole bytes per pixel");
+    }
+
+    size_t pixelBytes = pixelBits / 8;
+    size_t stride = source.rowBytes();
+    size_t outStride = width * pixelBytes;
+    image.setWidth(width);
+    image.setHeight(height);
+    image.setChannels(source.channels);
+    image.bitDepth = source.bitDepth;
+    image.allocateData(outStride * height);
+    for (uint32_t row = 0; row < height; row++) {
+        std::memcpy(image.data.data() + row * outStride,
+                    source.data.data() + (y + row) * stride + x * pixelBytes, outStride);
+    }
+    return true;
+}
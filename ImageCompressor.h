@@ -1,9 +1,14 @@
 #ifndef IMAGE_COMPRESSOR_H
 #define IMAGE_COMPRESSOR_H
 
+#include <algorithm>
+#include <fstream>
 #include <string>
 #include <vector>
 #include "PNGImage.h"
+#include "PNGRowReader.h"
+#include "ThreadPool.h"
+#include "SametFormat.h"
 
 /**
  * @file ImageCompressor.h
@@ -12,23 +17,225 @@
  * @date 2025
  */
 
+// How the compressor picks the codec and entropy coder of each block
+enum class CodecPolicy {
+    FIXED,          // the codec and entropy coder set on the compressor
+    MAX_RATIO,      // smallest estimated output
+    MAX_SPEED,      // shortest estimated time to read the block from storage and decode it
+    BUDGET          // fastest estimated decode within a size budget of the smallest output
+};
+
 class ImageCompressor {
 private:
+    ThreadPool* pool;
+    size_t blocksPerGroup;
+    uint16_t tileSize;
+    SametCodec codec;
+    size_t lzWindow;
+    SametEntropy entropy;
+    SametPredictor predictor;
+    bool colorTransform;
+    CodecPolicy policy;
+    double storageSpeed;
+    double sizeBudget;
+    std::string error;
+
     /**
-     * @brief Compresses raw image data
-     * @param data Raw image data to compress
-     * @return Compressed data as string
+     * @brief Fills in a version 2 header for an image; the index fields are set by finishFile()
      */
-    std::string compressData(const std::vector<unsigned char>& data);
+    SametHeader makeHeader(uint32_t width, uint32_t height, uint8_t channels,
+                           uint8_t bitDepth, uint64_t rawSize) const;
 
     /**
-     * @brief Decompresses compressed image data
-     * @param compressed Compressed image data
-     * @return Decompressed data as vector
+     * @brief Returns the predictor used for the blocks of an image, NONE where the pixel size has none
      */
-    std::vector<unsigned char> decompressData(const std::string& compressed);
+    SametPredictor predictorFor(const SametHeader& header) const;
+
+    /**
+     * @brief Returns the color transform used ahead of the predictor for the blocks of an image
+     */
+    SametColorTransform colorTransformFor(const SametHeader& header) const;
+
+    /**
+     * @brief Compresses a buffer group by group on the thread pool and writes the blocks
+     *
+     * Every header.blockSize bytes become one container block, a whole
+     * number of rows when a predictor is set. The blocks are encoded in
+     * parallel and written in order.
+     * @param file Output file, positioned at fileOffset
+     * @param header Header holding the image geometry and block size
+     * @param data Raw bytes to compress, starting on a block boundary
+     * @param size Number of bytes
+     * @param fileOffset Current write position, advanced past the written blocks
+     * @param index Block index the new entries are appended to
+     */
+    void writeBlocks(std::ostream& file, const SametHeader& header, const uint8_t* data, size_t size,
+                     uint64_t& fileOffset, std::vector<SametBlockEntry>& index);
+
+    /**
+     * @brief Cuts a band of full rows into tiles, compresses them on the thread pool and writes them
+     * @param file Output file, positioned at fileOffset
+     * @param header Header holding the image and tile geometry
+     * @param rows First row of the band, which must start on a tile boundary
+     * @param rowCount Number of rows, a multiple of the tile size except for the last band
+     * @param fileOffset Current write position, advanced past the written tiles
+     * @param index Block index the new entries are appended to
+     */
+    void writeTiles(std::ostream& file, const SametHeader& header, const uint8_t* rows,
+                    uint32_t rowCount, uint64_t& fileOffset, std::vector<SametBlockEntry>& index);
+
+    /**
+     * @brief Writes encoded blocks in order and records their offsets in the index
+     */
+    void appendBlocks(std::ostream& file, const std::vector<std::vector<uint8_t> >& blocks,
+                      std::vector<SametBlockEntry>& entries, uint64_t& fileOffset,
+                      std::vector<SametBlockEntry>& index);
+
+    /**
+     * @brief Appends the block index and writes the final header at the start of the file
+     * @return true if every write succeeded, false otherwise
+     */
+    bool finishFile(std::ostream& file, SametHeader& header,
+                    const std::vector<SametBlockEntry>& index, uint64_t fileOffset);
+
+    /**
+     * @brief Decodes one run-length stream of known decoded size on the thread pool
+     *
+     * A first pass cuts the stream into segments at token boundaries and
+     * sums their decoded sizes into output offsets; every segment is then
+     * expanded straight into its slice of the output.
+     * @return true if the stream is well formed and decodes to exactly dstSize bytes
+     */
+    bool decodeStream(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+    /**
+     * @brief Loads a version 2 file, decoding its blocks in parallel
+     * @param file Contents of the whole file
+     * @param image PNGImage object to store decompressed data
+     * @return true if successful, false otherwise
+     */
+    bool loadVersion2(ByteSpan file, PNGImage& image);
+
+    /**
+     * @brief Copies a rectangle of a decoded image into another image
+     * @return true if the rectangle lies inside the source, false otherwise
+     */
+    bool cropImage(const PNGImage& source, uint32_t x, uint32_t y,
+                   uint32_t width, uint32_t height, PNGImage& image);
+
+    /**
+     * @brief Prints an error, keeps it if it is the first of the operation and returns false
+     */
+    bool fail(const std::string& message);
 
 public:
+    /// Size of the independent blocks the run-length coder works on
+    static const size_t BLOCK_SIZE = 1024;
+    /// Default number of blocks handed to a thread at once
+    static const size_t DEFAULT_BLOCKS_PER_GROUP = 256;
+    /// Largest group, keeping container blocks well below 4 GB
+    static const size_t MAX_BLOCKS_PER_GROUP = 65536;
+    /// Smallest piece of a single stream worth decoding on its own thread
+    static const size_t MIN_STREAM_SEGMENT = 64 * 1024;
+    /// Number of slices a block is sampled with when picking its codec
+    static const size_t SAMPLE_SLICES = 4;
+    /// Size of every sampled slice; blocks up to twice the sample are tried whole
+    static const size_t SAMPLE_SLICE_SIZE = 8 * 1024;
+
+    /**
+     * @brief Constructor
+     * @param pool Thread pool used for compression, nullptr for the shared pool
+     */
+    explicit ImageCompressor(ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Sets how many 1024-byte blocks form one independently decodable container block
+     * @param blocks Blocks per group, at least 1
+     */
+    void setBlockGroupSize(size_t blocks) { blocksPerGroup = std::min(std::max<size_t>(blocks, 1), MAX_BLOCKS_PER_GROUP); }
+
+    /**
+     * @brief Stores pixel data as square tiles instead of linear blocks
+     *
+     * Tiled files let loadRegion() decode only the tiles a region touches.
+     * Images whose pixels are not a whole number of bytes are always stored
+     * linearly.
+     * @param size Tile edge in pixels, 0 for the linear layout
+     */
+    void setTileSize(uint16_t size) { tileSize = size; }
+
+    /**
+     * @brief Selects the codec the blocks of saved files are compressed with
+     *
+     * The codec is recorded in the header and in every index entry; blocks
+     * the codec does not shrink are stored raw.
+     * @param blockCodec SametCodec::RLE (the default), SametCodec::LZ or SametCodec::RAW
+     */
+    void setCodec(SametCodec blockCodec) { codec = blockCodec; }
+    SametCodec getCodec() const { return codec; }
+
+    /**
+     * @brief Sets how far back the LZ codec looks for matches
+     * @param window Window in bytes, clamped to what LZCodec supports
+     */
+    void setLZWindow(size_t window) { lzWindow = window; }
+
+    /**
+     * @brief Selects an entropy coder run over every block after its codec
+     *
+     * Huffman codes decode fastest; rANS gets closer to the entropy. Each
+     * block records whether the stage was applied, which it is only where
+     * it makes the block smaller.
+     * @param coder SametEntropy::NONE (the default), SametEntropy::HUFFMAN or SametEntropy::RANS
+     */
+    void setEntropy(SametEntropy coder) { entropy = coder; }
+    SametEntropy getEntropy() const { return entropy; }
+
+    /**
+     * @brief Selects a spatial predictor run over the pixels of every block before its codec
+     *
+     * Blocks then hold the difference of every byte from its prediction,
+     * which on photographic content is mostly small values the codecs and
+     * the entropy coder shrink far better than the pixels. Linear blocks are
+     * cut on row boundaries so that every row has the one above it.
+     * @param spatial SametPredictor::NONE (the default), LEFT, UP, AVERAGE or MED
+     */
+    void setPredictor(SametPredictor spatial) { predictor = spatial; }
+    SametPredictor getPredictor() const { return predictor; }
+
+    /**
+     * @brief Enables the YCoCg-R transform of 8-bit RGB and RGBA pixels ahead of the predictor
+     *
+     * It decorrelates the color channels; on by default, and only used
+     * together with a predictor.
+     */
+    void setColorTransform(bool enabled) { colorTransform = enabled; }
+
+    /**
+     * @brief Lets the compressor pick the codec and entropy coder of every block
+     *
+     * Each block is sampled and the sample compressed with every codec and
+     * entropy coder; the policy then weighs the estimated sizes against
+     * decode times from a model of measured throughputs. Every block records
+     * its choice, so files mixing flat, photographic and noisy regions keep
+     * each on the coding that suits it.
+     * @param codecPolicy CodecPolicy::FIXED (the default) uses setCodec() and setEntropy() for all blocks
+     */
+    void setCodecPolicy(CodecPolicy codecPolicy) { policy = codecPolicy; }
+    CodecPolicy getCodecPolicy() const { return policy; }
+
+    /**
+     * @brief Sets the storage throughput CodecPolicy::MAX_SPEED charges for every compressed byte
+     * @param megabytesPerSecond Read speed of the storage the files are loaded from, 500 by default
+     */
+    void setStorageSpeed(double megabytesPerSecond) { storageSpeed = std::max(megabytesPerSecond, 1.0); }
+
+    /**
+     * @brief Sets how much larger than the smallest choice CodecPolicy::BUDGET may make a block
+     * @param fraction Allowed growth, 0.05 (5%) by default
+     */
+    void setSizeBudget(double fraction) { sizeBudget = std::max(fraction, 0.0); }
+
     /**
      * @brief Saves image in compressed format
      * @param image PNGImage object to compress
@@ -38,12 +245,93 @@ public:
     bool saveCompressed(const PNGImage& image, const std::string& filename);
 
     /**
-     * @brief Loads compressed image
+     * @brief Saves pixels from any buffer in compressed format without copying them
+     * @param pixels Tightly packed scanlines
+     * @param width Image width
+     * @param height Image height
+     * @param channels Number of color channels
+     * @param bitDepth Bits per channel
+     * @param filename Output filename (without extension)
+     * @return true if successful, false otherwise
+     */
+    bool saveCompressed(ByteSpan pixels, uint32_t width, uint32_t height,
+                        uint8_t channels, uint8_t bitDepth, const std::string& filename);
+
+    /**
+     * @brief Compresses pixels into a seekable stream instead of a file
+     *
+     * Lets a pipeline encode into memory and leave the writing to another stage.
+     * @param pixels Tightly packed scanlines
+     * @param width Image width
+     * @param height Image height
+     * @param channels Number of color channels
+     * @param bitDepth Bits per channel
+     * @param out Output stream, positioned at its start
+     * @return true if successful, false otherwise
+     */
+    bool writeCompressed(ByteSpan pixels, uint32_t width, uint32_t height,
+                         uint8_t channels, uint8_t bitDepth, std::ostream& out);
+
+    /**
+     * @brief Saves an image in compressed format while it is being decoded
+     *
+     * Rows are pulled from the reader and written one at a time, so the whole
+     * image never has to be held in memory.
+     * @param reader PNGRowReader opened on the source image
+     * @param filename Output filename (without extension)
+     * @return true if successful, false otherwise
+     */
+    bool saveCompressed(PNGRowReader& reader, const std::string& filename);
+
+    /**
+     * @brief Loads compressed image, either a binary version 2 file or a version 1 text-header file
      * @param filename Input filename
      * @param image PNGImage object to store decompressed data
      * @return true if successful, false otherwise
      */
     bool loadCompressed(const std::string& filename, PNGImage& image);
+
+    /**
+     * @brief Loads a version 2 compressed image already read into memory
+     * @param file Contents of the whole file
+     * @param image PNGImage object to store decompressed data
+     * @return true if successful, false otherwise
+     */
+    bool loadCompressed(ByteSpan file, PNGImage& image);
+
+    /**
+     * @brief Loads a rectangle of a compressed image
+     *
+     * Only the index and the blocks that intersect the rectangle are read,
+     * with positioned reads, and decoded in parallel; for a tiled file the
+     * work depends on the size of the rectangle rather than of the image.
+     * Version 1 files are decoded whole and cropped.
+     * @param filename Input filename
+     * @param x Left edge of the rectangle
+     * @param y Top edge of the rectangle
+     * @param width Width of the rectangle
+     * @param height Height of the rectangle
+     * @param image PNGImage object receiving the rectangle
+     * @return true if successful, false otherwise
+     */
+    bool loadRegion(const std::string& filename, uint32_t x, uint32_t y,
+                    uint32_t width, uint32_t height, PNGImage& image);
+
+    /**
+     * @brief Reads the metadata of a compressed image without decoding any pixels
+     *
+     * Only the fixed header is read. Version 1 files report version 1, no
+     * blocks and a bit depth of 8.
+     * @param filename Input filename
+     * @param info Receives the header fields
+     * @return true if successful, false otherwise
+     */
+    bool readInfo(const std::string& filename, SametHeader& info);
+
+    /**
+     * @brief Returns a description of the first error of the last save, load or read
+     */
+    const std::string& getError() const { return error; }
 };
 
 #endif // IMAGE_COMPRESSOR_H 
\ No newline at end of file
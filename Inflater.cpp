@@ -0,0 +1,702 @@
+#include "Inflater.h"
+#include "Adler32.h"
+#include <cstring>
+#include <algorithm>
+
+/**
+ * @file Inflater.cpp
+ * @brief Implementation of the Inflater class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+// Decode table entry layout (32 bits):
+//   bits  0-7  : number of bits of the codeword (or primary bits for a subtable link)
+//   bits  8-11 : extra bits following the symbol (or index bits of a subtable)
+//   bits 12-15 : flags
+//   bits 16-31 : literal value, length/distance base, or subtable offset
+const uint32_t ENTRY_LITERAL = 0x1000;
+const uint32_t ENTRY_EOB = 0x2000;
+const uint32_t ENTRY_SUBTABLE = 0x4000;
+const uint32_t ENTRY_INVALID = 0x8000;
+
+const unsigned LITLEN_TABLE_BITS = 10;
+const unsigned DIST_TABLE_BITS = 8;
+const unsigned PRECODE_TABLE_BITS = 7;
+const unsigned MAX_CODE_BITS = 15;
+
+const unsigned NUM_LITLEN_SYMS = 288;
+const unsigned NUM_DIST_SYMS = 32;
+const unsigned NUM_PRECODE_SYMS = 19;
+
+// Sliding window used by read(): the deflate history plus room to decode ahead.
+const size_t WINDOW_HISTORY = 32768;
+const size_t WINDOW_SIZE = WINDOW_HISTORY * 3;
+
+const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+const uint8_t PRECODE_ORDER[NUM_PRECODE_SYMS] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+inline uint32_t makeEntry(uint32_t value, unsigned extra, uint32_t flags) {
+    return (value << 16) | (extra << 8) | flags;
+}
+
+// Per-symbol decode results, without the codeword length which the table
+// builder fills in.
+struct SymbolEntries {
+    uint32_t litlen[NUM_LITLEN_SYMS];
+    uint32_t dist[NUM_DIST_SYMS];
+    uint32_t precode[NUM_PRECODE_SYMS];
+
+    SymbolEntries() {
+        for (unsigned i = 0; i < 256; i++) {
+            litlen[i] = makeEntry(i, 0, ENTRY_LITERAL);
+        }
+        litlen[256] = makeEntry(0, 0, ENTRY_EOB);
+        for (unsigned i = 0; i < 29; i++) {
+            litlen[257 + i] = makeEntry(LENGTH_BASE[i], LENGTH_EXTRA[i], 0);
+        }
+        litlen[286] = litlen[287] = ENTRY_INVALID;
+
+        for (unsigned i = 0; i < 30; i++) {
+            dist[i] = makeEntry(DIST_BASE[i], DIST_EXTRA[i], 0);
+        }
+        dist[30] = dist[31] = ENTRY_INVALID;
+
+        for (unsigned i = 0; i < NUM_PRECODE_SYMS; i++) {
+            precode[i] = makeEntry(i, 0, 0);
+        }
+    }
+};
+
+const SymbolEntries& symbolEntries() {
+    static const SymbolEntries entries;
+    return entries;
+}
+
+unsigned reverseBits(unsigned code, unsigned length) {
+    unsigned result = 0;
+    for (unsigned i = 0; i < length; i++) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+/**
+ * Builds a two-level decode table for a canonical Huffman code. Codes up to
+ * tableBits long resolve with one lookup; longer codes go through a subtable
+ * linked from the primary entry of their first tableBits bits.
+ */
+bool buildDecodeTable(const uint8_t* lengths, unsigned numSyms, const uint32_t* entries,
+                      unsigned tableBits, std::vector<uint32_t>& table) {
+    unsigned count[MAX_CODE_BITS + 1] = {0};
+    for (unsigned sym = 0; sym < numSyms; sym++) {
+        count[lengths[sym]]++;
+    }
+    count[0] = 0;
+
+    int left = 1;
+    unsigned maxLength = 0;
+    for (unsigned len = 1; len <= MAX_CODE_BITS; len++) {
+        left <<= 1;
+        left -= static_cast<int>(count[len]);
+        if (left < 0) {
+            return false;
+        }
+        if (count[len] != 0) {
+            maxLength = len;
+        }
+    }
+
+    unsigned nextCode[MAX_CODE_BITS + 2];
+    unsigned code = 0;
+    nextCode[1] = 0;
+    for (unsigned len = 1; len <= MAX_CODE_BITS; len++) {
+        code = (code + count[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    table.assign(static_cast<size_t>(1) << tableBits, ENTRY_INVALID);
+    unsigned subBits = maxLength > tableBits ? maxLength - tableBits : 0;
+
+    for (unsigned sym = 0; sym < numSyms; sym++) {
+        unsigned len = lengths[sym];
+        if (len == 0) {
+            continue;
+        }
+        unsigned reversed = reverseBits(nextCode[len]++, len);
+        uint32_t entry = entries[sym] | len;
+
+        if (len <= tableBits) {
+            for (unsigned i = reversed; i < (1u << tableBits); i += 1u << len) {
+                table[i] = entry;
+            }
+            continue;
+        }
+
+        unsigned prefix = reversed & ((1u << tableBits) - 1);
+        if (!(table[prefix] & ENTRY_SUBTABLE)) {
+            uint32_t offset = static_cast<uint32_t>(table.size());
+            table.resize(table.size() + (static_cast<size_t>(1) << subBits), ENTRY_INVALID);
+            table[prefix] = makeEntry(offset, subBits, ENTRY_SUBTABLE) | tableBits;
+        }
+        size_t offset = table[prefix] >> 16;
+        unsigned step = 1u << (len - tableBits);
+        for (unsigned i = reversed >> tableBits; i < (1u << subBits); i += step) {
+            table[offset + i] = entry;
+        }
+    }
+    return true;
+}
+
+// Looks up the entry for the next codeword without consuming any bits.
+inline uint32_t lookup(const uint32_t* table, uint64_t bitBuffer, unsigned tableBits) {
+    uint32_t entry = table[bitBuffer & ((1u << tableBits) - 1)];
+    if (entry & ENTRY_SUBTABLE) {
+        unsigned subBits = (entry >> 8) & 0xF;
+        entry = table[(entry >> 16) + ((bitBuffer >> tableBits) & ((1u << subBits) - 1))];
+    }
+    return entry;
+}
+
+struct FixedTables {
+    std::vector<uint32_t> litlen;
+    std::vector<uint32_t> dist;
+
+    FixedTables() {
+        uint8_t lengths[NUM_LITLEN_SYMS];
+        std::fill(lengths, lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        buildDecodeTable(lengths, NUM_LITLEN_SYMS, symbolEntries().litlen, LITLEN_TABLE_BITS, litlen);
+
+        uint8_t distLengths[NUM_DIST_SYMS];
+        std::fill(distLengths, distLengths + NUM_DIST_SYMS, 5);
+        buildDecodeTable(distLengths, NUM_DIST_SYMS, symbolEntries().dist, DIST_TABLE_BITS, dist);
+    }
+};
+
+const FixedTables& fixedTables() {
+    static const FixedTables tables;
+    return tables;
+}
+
+inline uint64_t loadLE64(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t value;
+    std::memcpy(&value, p, 8);
+    return value;
+#else
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+#endif
+}
+
+// Copies a match of `length` bytes from `distance` bytes back. When at least
+// 8 bytes of slack follow the match the copy runs 8 bytes at a time and may
+// scribble past the end; those bytes are overwritten by later output.
+inline void copyMatch(uint8_t* out, size_t distance, size_t length, size_t slack) {
+    const uint8_t* src = out - distance;
+    if (distance >= 8 && slack >= 8) {
+        uint8_t* end = out + length;
+        do {
+            std::memcpy(out, src, 8);
+            out += 8;
+            src += 8;
+        } while (out < end);
+    } else if (distance == 1) {
+        std::memset(out, *src, length);
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            out[i] = src[i];
+        }
+    }
+}
+
+} // namespace
+
+Inflater::Inflater() {
+    litlenTable.reserve((1u << LITLEN_TABLE_BITS) + NUM_LITLEN_SYMS * 32);
+    distTable.reserve((1u << DIST_TABLE_BITS) + NUM_DIST_SYMS * 128);
+    reset();
+}
+
+void Inflater::reset() {
+    segments.clear();
+    segmentIndex = 0;
+    in = inEnd = nullptr;
+    provider = InputProvider();
+    windowPos = 0;
+    windowRead = 0;
+    bitBuffer = 0;
+    bitCount = 0;
+    overrun = 0;
+    state = State::ZLIB_HEADER;
+    lastBlock = false;
+    storedRemaining = 0;
+    pendingLength = 0;
+    pendingDistance = 0;
+    adler = 1;
+    litlen = dist = nullptr;
+    error.clear();
+}
+
+void Inflater::addInput(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    Segment segment = {data, size};
+    segments.push_back(segment);
+    if (in == inEnd && segmentIndex + 1 == segments.size()) {
+        in = data;
+        inEnd = data + size;
+    }
+}
+
+void Inflater::setInputProvider(InputProvider provider) {
+    this->provider = provider;
+}
+
+bool Inflater::inflate(uint8_t* out, size_t outSize, size_t& produced) {
+    size_t pos = 0;
+    bool ok = decodeChecked(out, pos, outSize);
+    produced = pos;
+    return ok;
+}
+
+bool Inflater::read(uint8_t* out, size_t size, size_t& produced) {
+    if (window.empty()) {
+        window.resize(WINDOW_SIZE);
+    }
+
+    produced = 0;
+    while (produced < size) {
+        if (windowRead < windowPos) {
+            size_t count = std::min(size - produced, windowPos - windowRead);
+            std::memcpy(out + produced, window.data() + windowRead, count);
+            windowRead += count;
+            produced += count;
+            continue;
+        }
+        if (state == State::DONE) {
+            break;
+        }
+        if (windowPos == window.size()) {
+            // Keep only the history that back-references can still reach.
+            std::memmove(window.data(), window.data() + windowPos - WINDOW_HISTORY, WINDOW_HISTORY);
+            windowPos = windowRead = WINDOW_HISTORY;
+        }
+        size_t start = windowPos;
+        if (!decodeChecked(window.data(), windowPos, window.size())) {
+            return false;
+        }
+        if (windowPos == start && state != State::DONE) {
+            return fail("Decoder made no progress");
+        }
+    }
+    return true;
+}
+
+bool Inflater::decodeChecked(uint8_t* base, size_t& pos, size_t limit) {
+    size_t checkedPos = pos;
+    bool ok = decode(base, pos, limit, checkedPos);
+    if (ok && checkedPos < pos) {
+        adler = Adler32::update(adler, base + checkedPos, pos - checkedPos);
+    }
+    return ok;
+}
+
+bool Inflater::fail(const char* message) {
+    state = State::FAILED;
+    error = message;
+    return false;
+}
+
+bool Inflater::nextSegment() {
+    while (segmentIndex + 1 < segments.size()) {
+        segmentIndex++;
+        in = segments[segmentIndex].data;
+        inEnd = in + segments[segmentIndex].size;
+        if (in != inEnd) {
+            return true;
+        }
+    }
+    if (provider) {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        while (provider(data, size)) {
+            if (size > 0) {
+                in = data;
+                inEnd = data + size;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+inline void Inflater::refill() {
+    if (inEnd - in >= 8) {
+        bitBuffer |= loadLE64(in) << bitCount;
+        in += (63 - bitCount) >> 3;
+        bitCount |= 56;
+    } else {
+        refillSlow();
+    }
+}
+
+void Inflater::refillSlow() {
+    while (bitCount <= 56) {
+        if (in == inEnd && !nextSegment()) {
+            // Past the end of the input: pad with zero bytes and remember how
+            // many were invented so consuming them can be reported later.
+            overrun++;
+            bitCount += 8;
+            continue;
+        }
+        bitBuffer |= static_cast<uint64_t>(*in++) << bitCount;
+        bitCount += 8;
+    }
+}
+
+bool Inflater::decode(uint8_t* base, size_t& pos, size_t limit, size_t& checkedPos) {
+    for (;;) {
+        switch (state) {
+            case State::ZLIB_HEADER: {
+                refill();
+                uint32_t cmf = bits(8);
+                uint32_t flg = (bitBuffer >> 8) & 0xFF;
+                consume(16);
+                if (bitCount < overrun * 8) {
+                    return fail("Truncated zlib header");
+                }
+                if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7) {
+                    return fail("Unsupported zlib compression method");
+                }
+                if (((cmf << 8) | flg) % 31 != 0) {
+                    return fail("Corrupt zlib header check bits");
+                }
+                if (flg & 0x20) {
+                    return fail("Preset dictionaries are not supported");
+                }
+                state = State::BLOCK_HEADER;
+                break;
+            }
+
+            case State::BLOCK_HEADER:
+                if (lastBlock) {
+                    state = State::TRAILER;
+                    break;
+                }
+                if (!readBlockHeader()) {
+                    return false;
+                }
+                break;
+
+            case State::STORED:
+                while (storedRemaining > 0) {
+                    if (pos == limit) {
+                        return true;
+                    }
+                    size_t count = std::min(storedRemaining, limit - pos);
+                    if (!copyStored(base + pos, count)) {
+                        return false;
+                    }
+                    pos += count;
+                    storedRemaining -= count;
+                }
+                state = State::BLOCK_HEADER;
+                break;
+
+            case State::HUFFMAN:
+                if (!decodeHuffman(base, pos, limit)) {
+                    return false;
+                }
+                if (state == State::HUFFMAN) {
+                    return true;
+                }
+                break;
+
+            case State::TRAILER:
+                adler = Adler32::update(adler, base + checkedPos, pos - checkedPos);
+                checkedPos = pos;
+                return readTrailer();
+
+            case State::DONE:
+                return true;
+
+            case State::FAILED:
+                return false;
+        }
+    }
+}
+
+bool Inflater::readBlockHeader() {
+    refill();
+    lastBlock = bits(1) != 0;
+    uint32_t type = (bitBuffer >> 1) & 3;
+    consume(3);
+
+    switch (type) {
+        case 0: {
+            consume(bitCount & 7);
+            uint32_t len = bits(16);
+            uint32_t nlen = (bitBuffer >> 16) & 0xFFFF;
+            consume(32);
+            if (bitCount < overrun * 8) {
+                return fail("Truncated stored block header");
+            }
+            if ((len ^ nlen) != 0xFFFF) {
+                return fail("Corrupt stored block length");
+            }
+            storedRemaining = len;
+            state = State::STORED;
+            return true;
+        }
+        case 1:
+            litlen = fixedTables().litlen.data();
+            dist = fixedTables().dist.data();
+            state = State::HUFFMAN;
+            return true;
+        case 2:
+            if (!readDynamicTables()) {
+                return false;
+            }
+            state = State::HUFFMAN;
+            return true;
+        default:
+            return fail("Invalid deflate block type");
+    }
+}
+
+bool Inflater::readDynamicTables() {
+    refill();
+    unsigned numLitlen = bits(5) + 257;
+    unsigned numDist = ((bitBuffer >> 5) & 0x1F) + 1;
+    unsigned numPrecode = ((bitBuffer >> 10) & 0xF) + 4;
+    consume(14);
+
+    if (numLitlen > 286 || numDist > 30) {
+        return fail("Too many length or distance codes");
+    }
+
+    uint8_t precodeLengths[NUM_PRECODE_SYMS] = {0};
+    for (unsigned i = 0; i < numPrecode; i++) {
+        refill();
+        precodeLengths[PRECODE_ORDER[i]] = static_cast<uint8_t>(bits(3));
+        consume(3);
+    }
+
+    std::vector<uint32_t> precodeTable;
+    if (!buildDecodeTable(precodeLengths, NUM_PRECODE_SYMS, symbolEntries().precode,
+                          PRECODE_TABLE_BITS, precodeTable)) {
+        return fail("Invalid code lengths code");
+    }
+
+    uint8_t lengths[NUM_LITLEN_SYMS + NUM_DIST_SYMS] = {0};
+    unsigned total = numLitlen + numDist;
+    unsigned i = 0;
+    while (i < total) {
+        refill();
+        uint32_t entry = precodeTable[bits(PRECODE_TABLE_BITS)];
+        if (entry & ENTRY_INVALID) {
+            return fail("Invalid code length symbol");
+        }
+        consume(entry & 0xFF);
+        unsigned sym = entry >> 16;
+
+        if (sym < 16) {
+            lengths[i++] = static_cast<uint8_t>(sym);
+            continue;
+        }
+
+        uint8_t value = 0;
+        unsigned repeat;
+        if (sym == 16) {
+            if (i == 0) {
+                return fail("Repeat code with no previous length");
+            }
+            value = lengths[i - 1];
+            repeat = 3 + bits(2);
+            consume(2);
+        } else if (sym == 17) {
+            repeat = 3 + bits(3);
+            consume(3);
+        } else {
+            repeat = 11 + bits(7);
+            consume(7);
+        }
+        if (i + repeat > total) {
+            return fail("Code length repeat overflows the table");
+        }
+        std::memset(lengths + i, value, repeat);
+        i += repeat;
+    }
+    if (bitCount < overrun * 8) {
+        return fail("Truncated dynamic block header");
+    }
+    if (lengths[256] == 0) {
+        return fail("Missing end-of-block code");
+    }
+
+    // Lengths for the unused symbols 286-287 / 30-31 are left at zero.
+    uint8_t distLengths[NUM_DIST_SYMS] = {0};
+    std::memcpy(distLengths, lengths + numLitlen, numDist);
+    std::memset(lengths + numLitlen, 0, NUM_LITLEN_SYMS - numLitlen);
+
+    if (!buildDecodeTable(lengths, NUM_LITLEN_SYMS, symbolEntries().litlen,
+                          LITLEN_TABLE_BITS, litlenTable)) {
+        return fail("Invalid literal/length code");
+    }
+    if (!buildDecodeTable(distLengths, NUM_DIST_SYMS, symbolEntries().dist,
+                          DIST_TABLE_BITS, distTable)) {
+        return fail("Invalid distance code");
+    }
+    litlen = litlenTable.data();
+    dist = distTable.data();
+    return true;
+}
+
+bool Inflater::decodeHuffman(uint8_t* base, size_t& pos, size_t limit) {
+    uint8_t* out = base + pos;
+    uint8_t* const outEnd = base + limit;
+
+    if (pendingLength > 0) {
+        size_t count = std::min(pendingLength, static_cast<size_t>(outEnd - out));
+        copyMatch(out, pendingDistance, count, outEnd - out - count);
+        out += count;
+        pendingLength -= count;
+        if (pendingLength > 0) {
+            pos = out - base;
+            return true;
+        }
+    }
+
+    for (;;) {
+        refill();
+        if (overrun > 8) {
+            return fail("Truncated deflate stream");
+        }
+
+        uint32_t entry = lookup(litlen, bitBuffer, LITLEN_TABLE_BITS);
+
+        if (out == outEnd && !(entry & ENTRY_EOB)) {
+            // Output is full; leave the symbol unconsumed for the next call.
+            break;
+        }
+        consume(entry & 0xFF);
+
+        if (entry & ENTRY_LITERAL) {
+            *out++ = static_cast<uint8_t>(entry >> 16);
+            continue;
+        }
+        if (entry & ENTRY_EOB) {
+            state = State::BLOCK_HEADER;
+            break;
+        }
+        if (entry & ENTRY_INVALID) {
+            return fail("Invalid literal/length symbol");
+        }
+
+        unsigned extra = (entry >> 8) & 0xF;
+        size_t length = (entry >> 16) + bits(extra);
+        consume(extra);
+
+        entry = lookup(dist, bitBuffer, DIST_TABLE_BITS);
+        if (entry & ENTRY_INVALID) {
+            return fail("Invalid distance symbol");
+        }
+        consume(entry & 0xFF);
+        extra = (entry >> 8) & 0xF;
+        size_t distance = (entry >> 16) + bits(extra);
+        consume(extra);
+
+        if (distance > static_cast<size_t>(out - base)) {
+            return fail("Distance points before the start of the output");
+        }
+
+        size_t space = outEnd - out;
+        if (length > space) {
+            pendingLength = length - space;
+            pendingDistance = distance;
+            length = space;
+        }
+        copyMatch(out, distance, length, space - length);
+        out += length;
+    }
+
+    if (bitCount < overrun * 8) {
+        return fail("Truncated deflate stream");
+    }
+    pos = out - base;
+    return true;
+}
+
+bool Inflater::copyStored(uint8_t* dst, size_t count) {
+    // Whole bytes still held in the bit buffer come first.
+    while (count > 0 && bitCount >= 8) {
+        if (bitCount - 8 < overrun * 8) {
+            return fail("Truncated stored block");
+        }
+        *dst++ = static_cast<uint8_t>(bitBuffer);
+        consume(8);
+        count--;
+    }
+    if (count == 0) {
+        return true;
+    }
+    bitBuffer = 0;
+    bitCount = 0;
+    overrun = 0;
+
+    while (count > 0) {
+        if (in == inEnd && !nextSegment()) {
+            return fail("Truncated stored block");
+        }
+        size_t n = std::min(count, static_cast<size_t>(inEnd - in));
+        std::memcpy(dst, in, n);
+        dst += n;
+        in += n;
+        count -= n;
+    }
+    return true;
+}
+
+bool Inflater::readTrailer() {
+    consume(bitCount & 7);
+    uint8_t bytes[4];
+    if (!copyStored(bytes, 4)) {
+        return fail("Truncated Adler-32 checksum");
+    }
+    uint32_t expected = (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) |
+                        (bytes[2] << 8) | bytes[3];
+    if (expected != adler) {
+        return fail("Adler-32 checksum mismatch");
+    }
+    state = State::DONE;
+    return true;
+}
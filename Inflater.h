@@ -0,0 +1,158 @@
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @file Inflater.h
+ * @brief Contains the Inflater class, a table-driven zlib/deflate decoder
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Decodes a zlib stream (RFC 1950/1951) spread over one or more input segments
+ *
+ * Input is registered as a list of segments (typically the payloads of the IDAT
+ * chunks) and is consumed in place without being concatenated. Huffman codes are
+ * decoded through two-level lookup tables and the bit buffer is refilled a
+ * 64-bit word at a time whenever enough input is available.
+ *
+ * Two output modes are available: inflate() decodes straight into a buffer that
+ * holds the whole result, while read() decodes through an internal sliding
+ * window so that arbitrarily long streams can be consumed with constant memory.
+ * Input can also be pulled on demand from an InputProvider instead of being
+ * registered up front.
+ */
+class Inflater {
+public:
+    /**
+     * @brief Callback supplying the next piece of compressed input
+     *
+     * Called whenever all registered input has been consumed. The bytes must
+     * stay valid until the provider is called again. Returning false signals
+     * the end of the input.
+     */
+    typedef std::function<bool(const uint8_t*& data, size_t& size)> InputProvider;
+
+    /**
+     * @brief Default constructor
+     */
+    Inflater();
+
+    /**
+     * @brief Discards all input and decoder state so a new stream can be decoded
+     */
+    void reset();
+
+    /**
+     * @brief Appends an input segment; the bytes must stay valid while decoding
+     * @param data Pointer to the compressed bytes
+     * @param size Number of bytes
+     */
+    void addInput(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Installs a callback that is asked for more input once the registered segments run out
+     * @param provider Input callback, or an empty function to remove it
+     */
+    void setInputProvider(InputProvider provider);
+
+    /**
+     * @brief Decodes the stream into a caller-provided buffer
+     * @param out Output buffer, also used as the back-reference history
+     * @param outSize Size of the output buffer
+     * @param produced Receives the number of bytes written
+     * @return true if no error occurred, false otherwise (see getError())
+     */
+    bool inflate(uint8_t* out, size_t outSize, size_t& produced);
+
+    /**
+     * @brief Decodes the next bytes of the stream, keeping the history in an internal window
+     *
+     * Unlike inflate(), successive calls continue where the previous one
+     * stopped and the output buffer does not need to hold earlier data. Fewer
+     * than size bytes are produced only at the end of the stream or on error.
+     * @param out Output buffer
+     * @param size Number of bytes wanted
+     * @param produced Receives the number of bytes written
+     * @return true if no error occurred, false otherwise (see getError())
+     */
+    bool read(uint8_t* out, size_t size, size_t& produced);
+
+    /**
+     * @brief Tells whether the end of the zlib stream (including Adler-32) was reached
+     */
+    bool finished() const { return state == State::DONE; }
+
+    /**
+     * @brief Returns a description of the last error
+     */
+    const std::string& getError() const { return error; }
+
+private:
+    enum class State {
+        ZLIB_HEADER,
+        BLOCK_HEADER,
+        STORED,
+        HUFFMAN,
+        TRAILER,
+        DONE,
+        FAILED
+    };
+
+    struct Segment {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    std::vector<Segment> segments;
+    size_t segmentIndex;
+    const uint8_t* in;
+    const uint8_t* inEnd;
+    InputProvider provider;
+
+    std::vector<uint8_t> window;
+    size_t windowPos;
+    size_t windowRead;
+
+    uint64_t bitBuffer;
+    unsigned bitCount;
+    size_t overrun;
+
+    State state;
+    bool lastBlock;
+    size_t storedRemaining;
+    size_t pendingLength;
+    size_t pendingDistance;
+    uint32_t adler;
+
+    std::vector<uint32_t> litlenTable;
+    std::vector<uint32_t> distTable;
+    const uint32_t* litlen;
+    const uint32_t* dist;
+
+    std::string error;
+
+    bool decode(uint8_t* base, size_t& pos, size_t limit, size_t& checkedPos);
+    bool decodeChecked(uint8_t* base, size_t& pos, size_t limit);
+    bool decodeHuffman(uint8_t* base, size_t& pos, size_t limit);
+    bool readBlockHeader();
+    bool readDynamicTables();
+    bool readTrailer();
+    bool copyStored(uint8_t* dst, size_t count);
+    bool nextSegment();
+    void refillSlow();
+    bool fail(const char* message);
+
+    inline void refill();
+    inline uint32_t bits(unsigned n) const { return static_cast<uint32_t>(bitBuffer & ((uint64_t(1) << n) - 1)); }
+    inline void consume(unsigned n) { bitBuffer >>= n; bitCount -= n; }
+
+};
+
+#endif // INFLATER_H
@@ -0,0 +1,324 @@
+#include "LZCodec.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @file LZCodec.cpp
+ * @brief Implementation of the LZCodec class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const size_t MIN_MATCH = 4;         // matches are found through a 4-byte hash
+const size_t LAST_LITERALS = 5;     // the stream always ends with this many literals
+const size_t MATCH_LIMIT = 12;      // no match starts closer than this to the end
+const size_t NICE_LENGTH = 256;     // stop searching once a match this long is found
+const unsigned MIN_HASH_BITS = 10;
+const unsigned MAX_HASH_BITS = 16;
+
+// Bytes the decoder may write past a copy, and read past a literal run, when
+// it copies in 16-byte steps.
+const size_t WILDCOPY_OVERRUN = 16;
+
+// After 2^SKIP_TRIGGER positions without a match the encoder starts skipping
+// ahead, one more byte per further 2^SKIP_TRIGGER misses, so incompressible
+// data goes through quickly.
+const unsigned SKIP_TRIGGER = 6;
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, 8);
+    return value;
+}
+
+inline uint32_t hash4(const uint8_t* p, unsigned bits) {
+    return (load32(p) * 0x9E3779B1u) >> (32 - bits);
+}
+
+// Counts how many bytes a and b have in common, up to maxLength.
+inline size_t matchLength(const uint8_t* a, const uint8_t* b, size_t maxLength) {
+    size_t length = 0;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (length + 8 <= maxLength) {
+        uint64_t diff = load64(a + length) ^ load64(b + length);
+        if (diff != 0) {
+            return length + (__builtin_ctzll(diff) >> 3);
+        }
+        length += 8;
+    }
+#endif
+    while (length < maxLength && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+inline void writeLength(uint8_t*& out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+}
+
+inline bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (in >= end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+uint8_t* writeSequence(uint8_t* out, const uint8_t* literals, size_t literalCount,
+                       size_t offset, size_t matchLength) {
+    uint8_t* token = out++;
+    size_t matchCode = matchLength - MIN_MATCH;
+    *token = static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) |
+                                  std::min<size_t>(matchCode, 15));
+    if (literalCount >= 15) {
+        writeLength(out, literalCount - 15);
+    }
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+    out[0] = static_cast<uint8_t>(offset);
+    out[1] = static_cast<uint8_t>(offset >> 8);
+    out += 2;
+    if (matchCode >= 15) {
+        writeLength(out, matchCode - 15);
+    }
+    return out;
+}
+
+// Copies in 16-byte steps until dst reaches end; may write up to 15 bytes
+// past end and read as far past the source.
+inline void wildCopy16(uint8_t* dst, const uint8_t* src, uint8_t* end) {
+    do {
+        std::memcpy(dst, src, 16);
+        dst += 16;
+        src += 16;
+    } while (dst < end);
+}
+
+// Expands a match that may overlap its own output. Needs WILDCOPY_OVERRUN
+// bytes of room past the match.
+inline void copyMatch(uint8_t* dst, size_t offset, size_t length) {
+    const uint8_t* match = dst - offset;
+    uint8_t* end = dst + length;
+    if (offset >= 16) {
+        wildCopy16(dst, match, end);
+        return;
+    }
+    if (offset == 1) {
+        std::memset(dst, *match, length);
+        return;
+    }
+    if (offset < 8) {
+        // Lay down whole periods one byte at a time until the pattern
+        // repeats at a distance of at least 8, then copy at that distance.
+        size_t step = offset * ((8 + offset - 1) / offset);
+        for (size_t i = 0; i < step; i++) {
+            dst[i] = match[i];
+        }
+        match = dst;
+        dst += step;
+    }
+    while (dst < end) {
+        std::memcpy(dst, match, 8);
+        dst += 8;
+        match += 8;
+    }
+}
+
+} // namespace
+
+const size_t LZCodec::MIN_WINDOW;
+const size_t LZCodec::MAX_WINDOW;
+const unsigned LZCodec::DEFAULT_CHAIN;
+
+LZCodec::LZCodec(size_t window, unsigned maxChain) : window(0), maxChain(1) {
+    setWindow(window);
+    setChainLength(maxChain);
+}
+
+void LZCodec::setWindow(size_t size) {
+    window = std::min(std::max(size, MIN_WINDOW), MAX_WINDOW);
+    // The chain links live in a ring larger than the window, so a link is
+    // never overwritten while the position it belongs to is still reachable.
+    size_t ring = 1;
+    while (ring <= window) {
+        ring <<= 1;
+    }
+    prev.resize(ring);
+}
+
+size_t LZCodec::compress(const uint8_t* data, size_t size, uint8_t* out) {
+    uint8_t* op = out;
+    size_t anchor = 0;
+
+    if (size > MATCH_LIMIT) {
+        unsigned hashBits = MIN_HASH_BITS;
+        while (hashBits < MAX_HASH_BITS && (static_cast<size_t>(1) << hashBits) < size) {
+            hashBits++;
+        }
+        // Positions are stored plus one, so 0 marks an empty slot. The links
+        // need no clearing: only positions inserted by this call are reached.
+        head.assign(static_cast<size_t>(1) << hashBits, 0);
+        size_t mask = prev.size() - 1;
+        size_t matchLimit = size - MATCH_LIMIT;
+        size_t matchEnd = size - LAST_LITERALS;
+
+        size_t pos = 0;
+        size_t misses = static_cast<size_t>(1) << SKIP_TRIGGER;
+        while (pos < matchLimit) {
+            uint32_t h = hash4(data + pos, hashBits);
+            size_t candidate = head[h];
+            prev[pos & mask] = static_cast<uint32_t>(candidate);
+            head[h] = static_cast<uint32_t>(pos + 1);
+
+            size_t maxLength = matchEnd - pos;
+            size_t niceLength = std::min(NICE_LENGTH, maxLength);
+            size_t best = 0;
+            size_t matchPos = 0;
+            uint32_t current4 = load32(data + pos);
+            unsigned chain = maxChain;
+            while (candidate != 0 && chain-- > 0) {
+                size_t at = candidate - 1;
+                if (pos - at > window) {
+                    break;
+                }
+                if (load32(data + at) == current4 &&
+                    (best == 0 || data[at + best] == data[pos + best])) {
+                    size_t length = MIN_MATCH + matchLength(data + at + MIN_MATCH, data + pos + MIN_MATCH,
+                                                            maxLength - MIN_MATCH);
+                    if (length > best) {
+                        best = length;
+                        matchPos = at;
+                        if (length >= niceLength) {
+                            break;
+                        }
+                    }
+                }
+                size_t next = prev[at & mask];
+                if (next >= candidate) {
+                    break;
+                }
+                candidate = next;
+            }
+
+            if (best < MIN_MATCH) {
+                pos += misses++ >> SKIP_TRIGGER;
+                continue;
+            }
+            misses = static_cast<size_t>(1) << SKIP_TRIGGER;
+
+            // Take back literals that also precede the earlier occurrence.
+            size_t start = pos;
+            while (start > anchor && matchPos > 0 && data[start - 1] == data[matchPos - 1]) {
+                start--;
+                matchPos--;
+                best++;
+            }
+
+            op = writeSequence(op, data + anchor, start - anchor, start - matchPos, best);
+            size_t end = start + best;
+            // Positions inside a byte run all hash alike and would push
+            // everything else out of reach of the chain; only the start of
+            // a run is remembered.
+            for (size_t p = pos + 1; p < std::min(end, matchLimit); p++) {
+                if (load32(data + p) == load32(data + p - 1)) {
+                    continue;
+                }
+                uint32_t hp = hash4(data + p, hashBits);
+                prev[p & mask] = head[hp];
+                head[hp] = static_cast<uint32_t>(p + 1);
+            }
+            pos = end;
+            anchor = end;
+        }
+    }
+
+    size_t literalCount = size - anchor;
+    *op++ = static_cast<uint8_t>(std::min<size_t>(literalCount, 15) << 4);
+    if (literalCount >= 15) {
+        writeLength(op, literalCount - 15);
+    }
+    if (literalCount != 0) {
+        std::memcpy(op, data + anchor, literalCount);
+        op += literalCount;
+    }
+    return static_cast<size_t>(op - out);
+}
+
+bool LZCodec::decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* ipEnd = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstSize;
+
+    for (;;) {
+        if (ip >= ipEnd) {
+            return false;
+        }
+        unsigned token = *ip++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(ip, ipEnd, literalCount)) {
+            return false;
+        }
+        size_t inLeft = static_cast<size_t>(ipEnd - ip);
+        size_t outLeft = static_cast<size_t>(opEnd - op);
+        if (literalCount > inLeft || literalCount > outLeft) {
+            return false;
+        }
+        if (inLeft >= literalCount + WILDCOPY_OVERRUN && outLeft >= literalCount + WILDCOPY_OVERRUN) {
+            wildCopy16(op, ip, op + literalCount);
+        } else if (literalCount != 0) {
+            std::memcpy(op, ip, literalCount);
+        }
+        ip += literalCount;
+        op += literalCount;
+
+        if (ip == ipEnd) {
+            return op == opEnd;
+        }
+        if (ipEnd - ip < 2) {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+            return false;
+        }
+
+        size_t length = token & 15;
+        if (length == 15 && !readLength(ip, ipEnd, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        outLeft = static_cast<size_t>(opEnd - op);
+        if (length > outLeft) {
+            return false;
+        }
+        if (outLeft >= length + WILDCOPY_OVERRUN) {
+            copyMatch(op, offset, length);
+        } else {
+            const uint8_t* match = op - offset;
+            for (size_t i = 0; i < length; i++) {
+                op[i] = match[i];
+            }
+        }
+        op += length;
+    }
+}
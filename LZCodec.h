@@ -0,0 +1,93 @@
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file LZCodec.h
+ * @brief Contains the LZCodec class, a byte-oriented LZ77 codec built for decode speed
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * Stream format, a sequence of sequences:
+ *
+ *   token                 high nibble: literal count, low nibble: match length - 4
+ *   [length bytes]        when a nibble is 15, bytes of 255 follow until one is smaller,
+ *                         all of them added to it
+ *   literals[count]
+ *   offset                2 bytes little-endian, 1 to the window size
+ *   [length bytes]        extension of the match length
+ *
+ * The last sequence has literals only and ends the stream. The encoder keeps
+ * the last LAST_LITERALS bytes as literals and starts no match closer than
+ * MATCH_LIMIT bytes to the end, so the decoder can copy in 16-byte steps
+ * nearly everywhere; streams that do not follow these rules still decode,
+ * through the checked path.
+ */
+
+/**
+ * @brief LZ77 codec with a hash-chain match finder and a configurable window
+ *
+ * An encoder object keeps its hash tables between calls and must not be
+ * shared between threads; decoding is stateless.
+ */
+class LZCodec {
+public:
+    static const size_t MIN_WINDOW = 1024;
+    static const size_t MAX_WINDOW = 65535;
+    static const unsigned DEFAULT_CHAIN = 16;
+
+    /**
+     * @brief Constructor
+     * @param window Farthest distance a match may reach back, clamped to [MIN_WINDOW, MAX_WINDOW]
+     * @param maxChain Candidates tried per position, at least 1
+     */
+    explicit LZCodec(size_t window = MAX_WINDOW, unsigned maxChain = DEFAULT_CHAIN);
+
+    void setWindow(size_t window);
+    size_t getWindow() const { return window; }
+    void setChainLength(unsigned chain) { maxChain = chain ? chain : 1; }
+    unsigned getChainLength() const { return maxChain; }
+
+    /**
+     * @brief Returns the worst-case encoded size of size input bytes
+     */
+    static size_t maxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+    /**
+     * @brief Returns the largest decoded size a stream of size bytes can have
+     *
+     * A length extension byte adds at most 255 bytes of match; a whole
+     * sequence without extensions yields less than 255 bytes per byte as well.
+     */
+    static uint64_t maxDecodedSize(size_t size) { return static_cast<uint64_t>(size) * 255; }
+
+    /**
+     * @brief Compresses a buffer into caller-provided memory
+     * @param data Input bytes
+     * @param size Number of input bytes
+     * @param out Output buffer of at least maxCompressedSize(size) bytes
+     * @return Number of bytes written
+     */
+    size_t compress(const uint8_t* data, size_t size, uint8_t* out);
+
+    /**
+     * @brief Decodes a stream whose decoded size is known in advance
+     * @param src Encoded bytes
+     * @param srcSize Number of encoded bytes
+     * @param dst Output buffer
+     * @param dstSize Exact decoded size
+     * @return true if the stream is well formed and decodes to exactly dstSize bytes
+     */
+    static bool decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+private:
+    size_t window;
+    unsigned maxChain;
+    std::vector<uint32_t> head;
+    std::vector<uint32_t> prev;
+};
+
+#endif // LZ_CODEC_H
@@ -0,0 +1,47 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file MappedFile.h
+ * @brief Contains MappedFile class, a read-only memory mapping of a whole file
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file read-only, replacing any previous mapping
+     * @param filename Path to the file
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Unmaps the file; pointers obtained from data() become invalid
+     */
+    void close();
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,420 @@
+#include "PNGFilter.h"
+#include "CPUFeatures.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * @file PNGFilter.cpp
+ * @brief Implementation of PNGFilter class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+void PNGFilter::filterRow(FilterType filterType, uint8_t* out, const uint8_t* row,
+                          const uint8_t* prior, size_t length, size_t bytesPerPixel) {
+    size_t bpp = std::min(bytesPerPixel, length);
+
+    switch (filterType) {
+        case FilterType::NONE:
+            std::memcpy(out, row, length);
+            break;
+
+        case FilterType::SUB:
+            std::memcpy(out, row, bpp);
+            for (size_t i = bpp; i < length; i++) {
+                out[i] = static_cast<uint8_t>(row[i] - row[i - bpp]);
+            }
+            break;
+
+        case FilterType::UP:
+            for (size_t i = 0; i < length; i++) {
+                out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+            }
+            break;
+
+        case FilterType::AVERAGE:
+            for (size_t i = 0; i < bpp; i++) {
+                out[i] = static_cast<uint8_t>(row[i] - (prior[i] >> 1));
+            }
+            for (size_t i = bpp; i < length; i++) {
+                out[i] = static_cast<uint8_t>(row[i] - ((row[i - bpp] + prior[i]) >> 1));
+            }
+            break;
+
+        case FilterType::PAETH:
+            for (size_t i = 0; i < bpp; i++) {
+                out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+            }
+            for (size_t i = bpp; i < length; i++) {
+                int a = row[i - bpp];
+                int b = prior[i];
+                int c = prior[i - bpp];
+                int pa = std::abs(b - c);
+                int pb = std::abs(a - c);
+                int pc = std::abs(a + b - 2 * c);
+                int predicted = pb <= pc ? b : c;
+                predicted = (pa <= pb && pa <= pc) ? a : predicted;
+                out[i] = static_cast<uint8_t>(row[i] - predicted);
+            }
+            break;
+    }
+}
+
+bool PNGFilter::unfilterRow(uint8_t filterType, uint8_t* row, const uint8_t* prior,
+                            size_t length, size_t bytesPerPixel) {
+    size_t bpp = bytesPerPixel;
+
+    switch (static_cast<FilterType>(filterType)) {
+        case FilterType::NONE:
+            break;
+
+        case FilterType::SUB:
+            for (size_t i = bpp; i < length; i++) {
+                row[i] = static_cast<uint8_t>(row[i] + row[i - bpp]);
+            }
+            break;
+
+        case FilterType::UP:
+            for (size_t i = 0; i < length; i++) {
+                row[i] = static_cast<uint8_t>(row[i] + prior[i]);
+            }
+            break;
+
+        case FilterType::AVERAGE:
+            for (size_t i = 0; i < bpp && i < length; i++) {
+                row[i] = static_cast<uint8_t>(row[i] + (prior[i] >> 1));
+            }
+            for (size_t i = bpp; i < length; i++) {
+                row[i] = static_cast<uint8_t>(row[i] + ((row[i - bpp] + prior[i]) >> 1));
+            }
+            break;
+
+        case FilterType::PAETH:
+            for (size_t i = 0; i < bpp && i < length; i++) {
+                row[i] = static_cast<uint8_t>(row[i] + prior[i]);
+            }
+            for (size_t i = bpp; i < length; i++) {
+                row[i] = static_cast<uint8_t>(row[i] +
+                         paethPredictor(row[i - bpp], prior[i], prior[i - bpp]));
+            }
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+namespace {
+
+// Scalar kernels, specialized on the pixel size so the inner loops unroll.
+
+template <size_t BPP>
+void subScalar(uint8_t* row, const uint8_t*, size_t length) {
+    for (size_t i = BPP; i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + row[i - BPP]);
+    }
+}
+
+void upScalar(uint8_t* row, const uint8_t* prior, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + prior[i]);
+    }
+}
+
+template <size_t BPP>
+void averageScalar(uint8_t* row, const uint8_t* prior, size_t length) {
+    for (size_t i = 0; i < BPP && i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + (prior[i] >> 1));
+    }
+    for (size_t i = BPP; i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + ((row[i - BPP] + prior[i]) >> 1));
+    }
+}
+
+template <size_t BPP>
+void paethScalar(uint8_t* row, const uint8_t* prior, size_t length) {
+    for (size_t i = 0; i < BPP && i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + prior[i]);
+    }
+    for (size_t i = BPP; i < length; i++) {
+        // Same predictor as paethPredictor(), written so it compiles to
+        // conditional moves instead of unpredictable branches.
+        int a = row[i - BPP];
+        int b = prior[i];
+        int c = prior[i - BPP];
+        int pa = std::abs(b - c);
+        int pb = std::abs(a - c);
+        int pc = std::abs(a + b - 2 * c);
+        int predicted = pb <= pc ? b : c;
+        predicted = (pa <= pb && pa <= pc) ? a : predicted;
+        row[i] = static_cast<uint8_t>(row[i] + predicted);
+    }
+}
+
+#ifdef CPU_X86_SIMD
+
+// Sub and Up have no dependency between the bytes of a vector other than the
+// running sum, so they work on 16/32 bytes at a time. Average and Paeth depend
+// on the previous reconstructed pixel and therefore step one pixel at a time,
+// with all channels of the pixel processed in one vector.
+
+// Loads a pixel into the low lanes. The wide variant reads 8 bytes, which is
+// only done while 8 bytes remain in the row; the extra lanes carry unrelated
+// bytes that never cross into the pixel lanes and are never stored.
+template <size_t BPP>
+TARGET_SSE2 inline __m128i loadPixel(const uint8_t* p) {
+    if (BPP == 4) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return _mm_cvtsi32_si128(static_cast<int>(v));
+    }
+    uint64_t v = 0;
+    std::memcpy(&v, p, BPP);
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&v));
+}
+
+TARGET_SSE2 inline __m128i loadPixelWide(const uint8_t* p) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+}
+
+template <size_t BPP>
+TARGET_SSE2 inline void storePixel(uint8_t* p, __m128i x) {
+    if (BPP <= 4) {
+        uint32_t v = static_cast<uint32_t>(_mm_cvtsi128_si32(x));
+        std::memcpy(p, &v, BPP);
+        return;
+    }
+    uint64_t v;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&v), x);
+    std::memcpy(p, &v, BPP);
+}
+
+TARGET_SSE2
+void upSSE2(uint8_t* row, const uint8_t* prior, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_add_epi8(x, b));
+    }
+    upScalar(row + i, prior + i, length - i);
+}
+
+TARGET_AVX2
+void upAVX2(uint8_t* row, const uint8_t* prior, size_t length) {
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prior + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), _mm256_add_epi8(x, b));
+    }
+    upScalar(row + i, prior + i, length - i);
+}
+
+// For power-of-two pixel sizes Sub is a strided prefix sum: log2(16 / BPP)
+// shifted adds inside the vector plus the last pixel of the previous vector
+// broadcast to every pixel slot.
+template <size_t BPP>
+TARGET_SSE2 inline __m128i broadcastLastPixel(__m128i x) {
+    switch (BPP) {
+        case 1: {
+            __m128i t = _mm_srli_si128(x, 15);
+            t = _mm_unpacklo_epi8(t, t);
+            t = _mm_shufflelo_epi16(t, 0);
+            return _mm_shuffle_epi32(t, 0);
+        }
+        case 2:
+            return _mm_shuffle_epi32(_mm_shufflehi_epi16(x, 0xFF), 0xFF);
+        case 4:
+            return _mm_shuffle_epi32(x, 0xFF);
+        default:
+            return _mm_unpackhi_epi64(x, x);
+    }
+}
+
+template <size_t BPP>
+TARGET_SSE2
+void subPrefixSSE2(uint8_t* row, const uint8_t*, size_t length) {
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        x = _mm_add_epi8(x, _mm_slli_si128(x, BPP));
+        if (BPP <= 4) x = _mm_add_epi8(x, _mm_slli_si128(x, 2 * BPP));
+        if (BPP <= 2) x = _mm_add_epi8(x, _mm_slli_si128(x, 4 * BPP));
+        if (BPP <= 1) x = _mm_add_epi8(x, _mm_slli_si128(x, 8 * BPP));
+        x = _mm_add_epi8(x, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), x);
+        carry = broadcastLastPixel<BPP>(x);
+    }
+    for (i = i < BPP ? BPP : i; i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + row[i - BPP]);
+    }
+}
+
+// Sub for 3- and 6-byte pixels: a prefix sum over the 12 bytes (4 or 2
+// pixels) of each vector, with the last pixel of the previous step
+// broadcast by a byte shuffle. The upper 4 bytes are written back unchanged.
+template <size_t BPP>
+TARGET_SSSE3
+void subPrefixSSSE3(uint8_t* row, const uint8_t*, size_t length) {
+    const __m128i broadcast = BPP == 3
+        ? _mm_setr_epi8(9, 10, 11, 9, 10, 11, 9, 10, 11, 9, 10, 11, -1, -1, -1, -1)
+        : _mm_setr_epi8(6, 7, 8, 9, 10, 11, 6, 7, 8, 9, 10, 11, -1, -1, -1, -1);
+    const __m128i low12 = _mm_setr_epi32(-1, -1, -1, 0);
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 12) {
+        __m128i original = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i x = _mm_add_epi8(original, _mm_slli_si128(original, BPP));
+        if (BPP == 3) x = _mm_add_epi8(x, _mm_slli_si128(x, 6));
+        x = _mm_add_epi8(x, carry);
+        x = _mm_or_si128(_mm_and_si128(low12, x), _mm_andnot_si128(low12, original));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), x);
+        carry = _mm_shuffle_epi8(x, broadcast);
+    }
+    for (i = i < BPP ? BPP : i; i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + row[i - BPP]);
+    }
+}
+
+template <size_t BPP>
+TARGET_SSE2 inline __m128i averageStep(__m128i a, __m128i x, __m128i b) {
+    // _mm_avg_epu8 rounds up; subtract the carry to get floor((a + b) / 2).
+    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+    return _mm_add_epi8(x, avg);
+}
+
+template <size_t BPP>
+TARGET_SSE2
+void averageSSE2(uint8_t* row, const uint8_t* prior, size_t length) {
+    __m128i a = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= length; i += BPP) {
+        a = averageStep<BPP>(a, loadPixelWide(row + i), loadPixelWide(prior + i));
+        storePixel<BPP>(row + i, a);
+    }
+    for (; i + BPP <= length; i += BPP) {
+        a = averageStep<BPP>(a, loadPixel<BPP>(row + i), loadPixel<BPP>(prior + i));
+        storePixel<BPP>(row + i, a);
+    }
+}
+
+TARGET_SSE2 inline __m128i selectBits(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+TARGET_SSE2 inline __m128i absSSE2(__m128i x) {
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+TARGET_SSSE3 inline __m128i absSSSE3(__m128i x) {
+    return _mm_abs_epi16(x);
+}
+
+// Paeth on 16-bit lanes: p - a = b - c, p - b = a - c, p - c = (b - c) + (a - c).
+// Ties favour a over b over c as required by the specification. The step
+// returns the reconstructed pixel widened to 16 bits; a becomes it and c
+// becomes b for the next pixel.
+#define PAETH_STEP(ABS, xRaw, bRaw)                                                   \
+    do {                                                                              \
+        __m128i b = _mm_unpacklo_epi8((bRaw), zero);                                  \
+        __m128i pa = _mm_sub_epi16(b, c);                                             \
+        __m128i pb = _mm_sub_epi16(a, c);                                             \
+        __m128i pc = ABS(_mm_add_epi16(pa, pb));                                      \
+        pa = ABS(pa);                                                                 \
+        pb = ABS(pb);                                                                 \
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));                  \
+        __m128i predicted = selectBits(_mm_cmpeq_epi16(smallest, pa), a,              \
+                            selectBits(_mm_cmpeq_epi16(smallest, pb), b, c));         \
+        __m128i x = _mm_add_epi8((xRaw), _mm_packus_epi16(predicted, zero));          \
+        storePixel<BPP>(row + i, x);                                                  \
+        a = _mm_unpacklo_epi8(x, zero);                                               \
+        c = b;                                                                        \
+    } while (0)
+
+template <size_t BPP>
+TARGET_SSE2
+void paethSSE2(uint8_t* row, const uint8_t* prior, size_t length) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    size_t i = 0;
+    for (; i + 8 <= length; i += BPP) {
+        PAETH_STEP(absSSE2, loadPixelWide(row + i), loadPixelWide(prior + i));
+    }
+    for (; i + BPP <= length; i += BPP) {
+        PAETH_STEP(absSSE2, loadPixel<BPP>(row + i), loadPixel<BPP>(prior + i));
+    }
+}
+
+template <size_t BPP>
+TARGET_SSSE3
+void paethSSSE3(uint8_t* row, const uint8_t* prior, size_t length) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    size_t i = 0;
+    for (; i + 8 <= length; i += BPP) {
+        PAETH_STEP(absSSSE3, loadPixelWide(row + i), loadPixelWide(prior + i));
+    }
+    for (; i + BPP <= length; i += BPP) {
+        PAETH_STEP(absSSSE3, loadPixel<BPP>(row + i), loadPixel<BPP>(prior + i));
+    }
+}
+
+#undef PAETH_STEP
+
+#endif // CPU_X86_SIMD
+
+template <size_t BPP>
+PNGFilter::UnfilterKernels kernelsFor() {
+    PNGFilter::UnfilterKernels kernels = {subScalar<BPP>, upScalar, averageScalar<BPP>, paethScalar<BPP>};
+
+#ifdef CPU_X86_SIMD
+    const CPUFeatures& cpu = CPUFeatures::get();
+    if (cpu.sse2) {
+        kernels.up = upSSE2;
+        if (BPP == 1 || BPP == 2 || BPP == 4 || BPP == 8) {
+            kernels.sub = subPrefixSSE2<BPP>;
+        }
+        // One- and two-byte pixels gain nothing from per-pixel vectors.
+        if (BPP >= 3) {
+            kernels.average = averageSSE2<BPP>;
+            kernels.paeth = paethSSE2<BPP>;
+        }
+    }
+    // The scalar loop is already faster than a 2-pixel prefix for BPP 6.
+    if (cpu.ssse3 && BPP == 3) {
+        kernels.sub = subPrefixSSSE3<BPP>;
+    }
+    if (cpu.ssse3 && BPP >= 3) {
+        kernels.paeth = paethSSSE3<BPP>;
+    }
+    if (cpu.avx2) {
+        kernels.up = upAVX2;
+    }
+#endif
+
+    return kernels;
+}
+
+} // namespace
+
+PNGFilter::UnfilterKernels PNGFilter::selectUnfilterKernels(size_t bytesPerPixel) {
+    switch (bytesPerPixel) {
+        case 1: return kernelsFor<1>();
+        case 2: return kernelsFor<2>();
+        case 3: return kernelsFor<3>();
+        case 4: return kernelsFor<4>();
+        case 6: return kernelsFor<6>();
+        default: return kernelsFor<8>();
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef PNG_FILTER_H
+#define PNG_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "PNGStructs.h"
+
+/**
+ * @file PNGFilter.h
+ * @brief Contains PNGFilter class for PNG scanline filtering operations
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+class PNGFilter {
+public:
+    /**
+     * @brief Applies a filter to one scanline
+     * @param filterType Filter to apply
+     * @param out Destination for the filtered bytes (length bytes)
+     * @param row Original scanline bytes
+     * @param prior Previous original scanline, all zeros for the first row
+     * @param length Number of bytes in the scanline
+     * @param bytesPerPixel Distance in bytes to the corresponding byte of the left pixel
+     */
+    static void filterRow(FilterType filterType, uint8_t* out, const uint8_t* row,
+                          const uint8_t* prior, size_t length, size_t bytesPerPixel);
+
+    /**
+     * @brief Signature of a kernel that reverses one filter type on a scanline in place
+     */
+    typedef void (*UnfilterFunction)(uint8_t* row, const uint8_t* prior, size_t length);
+
+    /**
+     * @brief Unfilter kernels for one pixel size, chosen once per image
+     */
+    struct UnfilterKernels {
+        UnfilterFunction sub;
+        UnfilterFunction up;
+        UnfilterFunction average;
+        UnfilterFunction paeth;
+    };
+
+    /**
+     * @brief Picks the fastest kernels the CPU supports for a pixel size
+     * @param bytesPerPixel Filter pixel size in bytes (1, 2, 3, 4, 6 or 8)
+     * @return Kernel table to pass to unfilterRow()
+     */
+    static UnfilterKernels selectUnfilterKernels(size_t bytesPerPixel);
+
+    /**
+     * @brief Reverses the filter of one scanline in place using preselected kernels
+     * @param kernels Kernel table from selectUnfilterKernels()
+     * @param filterType Filter type byte that preceded the scanline
+     * @param row Scanline bytes (without the filter type byte)
+     * @param prior Previous reconstructed scanline, all zeros for the first row
+     * @param length Number of bytes in the scanline
+     * @return true if successful, false for an unknown filter type
+     */
+    static inline bool unfilterRow(const UnfilterKernels& kernels, uint8_t filterType,
+                                   uint8_t* row, const uint8_t* prior, size_t length) {
+        switch (static_cast<FilterType>(filterType)) {
+            case FilterType::NONE: return true;
+            case FilterType::SUB: kernels.sub(row, prior, length); return true;
+            case FilterType::UP: kernels.up(row, prior, length); return true;
+            case FilterType::AVERAGE: kernels.average(row, prior, length); return true;
+            case FilterType::PAETH: kernels.paeth(row, prior, length); return true;
+            default: return false;
+        }
+    }
+
+    /**
+     * @brief Scalar reference: reverses the filter of one scanline in place
+     * @param filterType Filter type byte that preceded the scanline
+     * @param row Scanline bytes (without the filter type byte)
+     * @param prior Previous reconstructed scanline, all zeros for the first row
+     * @param length Number of bytes in the scanline
+     * @param bytesPerPixel Distance in bytes to the corresponding byte of the left pixel
+     * @return true if successful, false for an unknown filter type
+     */
+    static bool unfilterRow(uint8_t filterType, uint8_t* row, const uint8_t* prior,
+                            size_t length, size_t bytesPerPixel);
+
+    /**
+     * @brief Paeth predictor as defined by the PNG specification
+     */
+    static inline uint8_t paethPredictor(int a, int b, int c) {
+        int p = a + b - c;
+        int pa = p > a ? p - a : a - p;
+        int pb = p > b ? p - b : b - p;
+        int pc = p > c ? p - c : c - p;
+        if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+        if (pb <= pc) return static_cast<uint8_t>(b);
+        return static_cast<uint8_t>(c);
+    }
+};
+
+#endif // PNG_FILTER_H
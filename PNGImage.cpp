@@ -1,7 +1,18 @@
 #include "PNGImage.h"
+#include "Inflater.h"
+#include "Deflater.h"
+#include "PNGFilter.h"
+#include "MappedFile.h"
+#include "CRC32.h"
+#include "ThreadPool.h"
+#include "BufferPool.h"
+#include "Console.h"
+#include "Stats.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 
 /**
  * @file PNGImage.cpp
@@ -10,117 +21,246 @@
  * @date 2025
  */
 
+namespace {
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// Deflate codes at most 258 bytes with two bits, so no stream inflates to
+// more than this many times its size.
+const size_t MAX_INFLATE_RATIO = 1032;
+
+// Largest width or height the PNG specification allows.
+const uint32_t MAX_DIMENSION = 0x7FFFFFFF;
+
+// Adam7 passes as log2 of their first column, first row, column step and row step.
+struct Adam7Pass {
+    unsigned xStart;
+    unsigned yStart;
+    unsigned xShift;
+    unsigned yShift;
+};
+
+const int ADAM7_PASSES = 7;
+
+const Adam7Pass ADAM7[ADAM7_PASSES] = {
+    {0, 0, 3, 3}, {4, 0, 3, 3}, {0, 4, 2, 3}, {2, 0, 2, 2}, {0, 2, 1, 2}, {1, 0, 1, 1}, {0, 1, 0, 1}
+};
+
+// Grid of the pixels known after each pass, as log2 of its column and row step.
+const unsigned PREVIEW_SHIFT[ADAM7_PASSES][2] = {
+    {3, 3}, {2, 3}, {2, 2}, {1, 2}, {1, 1}, {0, 1}, {0, 0}
+};
+
+// Number of positions start, start + 2^shift, ... below size.
+inline uint32_t passExtent(uint32_t size, unsigned start, unsigned shift) {
+    return size > start ? ((size - start - 1) >> shift) + 1 : 0;
+}
+
+} // namespace
+
 PNGImage::PNGImage() : width(0), height(0), channels(3), bitDepth(8), 
-                       colorType(ColorType::RGB) {}
+                       colorType(ColorType::RGB), interlaced(false), filterStrategy(FilterStrategy::MIN_SUM),
+                       paletteEntries(0), transparentPalette(false) {}
 
-bool PNGImage::readPNG(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cout << "Error: Cannot open file " << filename << std::endl;
-        return false;
+PNGImage::~PNGImage() {
+    BufferPool::shared().release(data);
+}
+
+void PNGImage::setData(std::vector<uint8_t>&& newData) {
+    BufferPool::shared().release(data);
+    data = std::move(newData);
+}
+
+std::vector<uint8_t> PNGImage::takeData() {
+    std::vector<uint8_t> taken;
+    taken.swap(data);
+    return taken;
+}
+
+bool PNGImage::readPNG(const std::string& filename, const ProgressCallback& progress) {
+    error.clear();
+    MappedFile file;
+    if (!file.open(filename)) {
+        return fail("Cannot open file " + filename);
     }
 
-    file.seekg(0, std::ios::end);
-    std::streamsize fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    if (fileSize < 8) {
-        std::cout << "Error: File is too small to be a PNG" << std::endl;
-        return false;
+    // The mapping stays open until decoding is done.
+    ByteSpan bytes = {file.data(), file.size()};
+    return decodePNG(bytes, progress);
+}
+
+bool PNGImage::decodePNG(ByteSpan file, const ProgressCallback& progress) {
+    ScopedTimer timer(Stage::PNG_DECODE);
+    error.clear();
+    if (file.size < 8) {
+        return fail("File is too small to be a PNG");
     }
 
-    uint8_t signature[8];
-    file.read(reinterpret_cast<char*>(signature), 8);
+    if (!std::equal(file.data, file.data + 8, PNGSignature::data)) {
+        return fail("Invalid PNG signature - File is not a PNG image");
+    }
 
-    if (!std::equal(std::begin(signature), std::end(signature), PNGSignature::data)) {
-        std::cout << "Error: Invalid PNG signature - File is not a PNG image" << std::endl;
+    std::vector<PNGChunkView> chunks;
+    if (!readChunkTable(file, chunks)) {
         return false;
     }
-        
-    PNGChunk chunk;
+
     bool foundIHDR = false;
-    std::vector<uint8_t> imageData;
+    std::vector<ByteSpan> idatSpans;
 
-    while (file) {
-        if (!readChunk(file, chunk)) {
-            break;
-        }
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const PNGChunkView& chunk = chunks[i];
+        const uint8_t* chunkData = file.data + chunk.offset;
 
         switch (chunk.type) {
             case static_cast<uint32_t>(ChunkType::IHDR):
-                if (!processIHDR(chunk.data)) {
-                    std::cout << "Error: Failed to process IHDR chunk" << std::endl;
-                    return false;
+                if (!processIHDR(chunkData, chunk.length)) {
+                    return fail("Failed to process IHDR chunk");
                 }
                 foundIHDR = true;
                 break;
 
-            case static_cast<uint32_t>(ChunkType::IDAT):
-                imageData.insert(imageData.end(), chunk.data.begin(), chunk.data.end());
+            case static_cast<uint32_t>(ChunkType::PLTE):
+                if (foundIHDR && !processPLTE(chunkData, chunk.length)) {
+                    return false;
+                }
                 break;
 
-            case static_cast<uint32_t>(ChunkType::IEND):
-                if (foundIHDR && !imageData.empty()) {
-                    data = imageData;
-                    return true;
+            case static_cast<uint32_t>(ChunkType::TRNS):
+                if (foundIHDR && !processTRNS(chunkData, chunk.length)) {
+                    return false;
                 }
                 break;
+
+            case static_cast<uint32_t>(ChunkType::IDAT): {
+                ByteSpan span = {chunkData, chunk.length};
+                idatSpans.push_back(span);
+                break;
+            }
         }
     }
 
     if (!foundIHDR) {
-        std::cout << "Error: No IHDR chunk found" << std::endl;
-        return false;
+        return fail("No IHDR chunk found");
     }
 
-    if (imageData.empty()) {
-        std::cout << "Error: No image data found (no IDAT chunks)" << std::endl;
-        return false;
+    if (idatSpans.empty()) {
+        return fail("No image data found (no IDAT chunks)");
     }
 
-    data = imageData;
+    // The spans point into the file contents, which the caller keeps alive.
+    if (!decodeImageData(idatSpans, progress)) {
+        return false;
+    }
+    timer.setBytes(file.size, data.size());
     return true;
 }
 
 bool PNGImage::savePNG(const std::string& filename, const std::vector<uint8_t>& newData,
-                       uint32_t newWidth, uint32_t newHeight, uint8_t newChannels) {
+                       uint32_t newWidth, uint32_t newHeight, uint8_t newChannels,
+                       int compressionLevel) {
+    ByteSpan pixels = {newData.data(), newData.size()};
+    return savePNG(filename, pixels, newWidth, newHeight, newChannels, compressionLevel);
+}
+
+bool PNGImage::savePNG(const std::string& filename, ByteSpan pixels,
+                       uint32_t newWidth, uint32_t newHeight, uint8_t newChannels,
+                       int compressionLevel) {
+    if (!prepareSave(pixels, newWidth, newHeight, newChannels)) {
+        return false;
+    }
+
     std::ofstream file(filename, std::ios::binary);
     if (!file) {
-        std::cout << "Error: Cannot create PNG file" << std::endl;
+        return fail("Cannot create PNG file");
+    }
+
+    size_t compressedSize = 0;
+    if (!writeImage(file, pixels, compressionLevel, compressedSize)) {
         return false;
     }
 
-    file.write(reinterpret_cast<const char*>(PNGSignature::data), 8);
+    CONSOLE_INFO("PNG file saved successfully:" << std::endl);
+    CONSOLE_INFO("Width: " << width << std::endl);
+    CONSOLE_INFO("Height: " << height << std::endl);
+    CONSOLE_INFO("Channels: " << (int)channels << std::endl);
+    CONSOLE_INFO("Total pixels: " << (width * height) << std::endl);
+    CONSOLE_INFO("Data size: " << pixels.size << " bytes" << std::endl);
+    CONSOLE_INFO("Compressed size: " << compressedSize << " bytes" << std::endl);
 
+    return true;
+}
+
+bool PNGImage::writePNG(std::ostream& out, ByteSpan pixels,
+                        uint32_t newWidth, uint32_t newHeight, uint8_t newChannels,
+                        int compressionLevel) {
+    size_t compressedSize = 0;
+    return prepareSave(pixels, newWidth, newHeight, newChannels) &&
+           writeImage(out, pixels, compressionLevel, compressedSize);
+}
+
+bool PNGImage::prepareSave(ByteSpan pixels, uint32_t newWidth, uint32_t newHeight, uint8_t newChannels) {
+    error.clear();
     width = newWidth;
     height = newHeight;
     channels = newChannels;
-    colorType = channels == 1 ? ColorType::GRAYSCALE : 
-                channels == 3 ? ColorType::RGB : ColorType::RGBA;
+    if (!PixelFormat::colorTypeFor(channels, bitDepth, colorType)) {
+        return fail("PNG cannot store " + std::to_string(channels) + " channels of " +
+                    std::to_string(bitDepth) + " bits");
+    }
 
-    if (!writeChunk(file, static_cast<uint32_t>(ChunkType::IHDR), createIHDR())) {
+    if (pixels.size != rowBytes() * height) {
+        fail("Image data size does not match the dimensions");
+        std::cout << "Expected: " << rowBytes() * height << " bytes" << std::endl;
+        std::cout << "Given: " << pixels.size << " bytes" << std::endl;
         return false;
     }
+    return true;
+}
 
-    std::vector<uint8_t> idat_data = newData;
+bool PNGImage::writeImage(std::ostream& file, ByteSpan pixels, int compressionLevel, size_t& compressedSize) {
+    ScopedTimer timer(Stage::PNG_ENCODE);
+    file.write(reinterpret_cast<const char*>(PNGSignature::data), 8);
 
-    if (!writeChunk(file, static_cast<uint32_t>(ChunkType::IDAT), idat_data)) {
-        std::cout << "Error: Failed to write IDAT chunk" << std::endl;
+    if (!writeChunk(file, static_cast<uint32_t>(ChunkType::IHDR), createIHDR())) {
         return false;
     }
 
-    if (!writeChunk(file, static_cast<uint32_t>(ChunkType::IEND), std::vector<uint8_t>())) {
-        std::cout << "Error: Failed to write IEND chunk" << std::endl;
-        return false;
+    // Images larger than one deflate segment are compressed segment by
+    // segment on the thread pool; every segment becomes its own IDAT chunk.
+    std::vector<uint8_t> filtered = filterScanlines(pixels.data);
+    std::vector<std::vector<uint8_t> > idat_data(1);
+    {
+        ScopedTimer deflateTimer(Stage::PNG_DEFLATE);
+        Deflater deflater(compressionLevel);
+        if (filtered.size() > Deflater::SEGMENT_SIZE) {
+            deflater.compressParallel(filtered.data(), filtered.size(), ThreadPool::shared(), idat_data);
+        } else {
+            deflater.compress(filtered.data(), filtered.size(), idat_data[0]);
+        }
+        size_t deflated = 0;
+        for (size_t i = 0; i < idat_data.size(); i++) {
+            deflated += idat_data[i].size();
+        }
+        deflateTimer.setBytes(filtered.size(), deflated);
     }
 
-    std::cout << "PNG file saved successfully:" << std::endl;
-    std::cout << "Width: " << width << std::endl;
-    std::cout << "Height: " << height << std::endl;
-    std::cout << "Channels: " << (int)channels << std::endl;
-    std::cout << "Total pixels: " << (width * height) << std::endl;
-    std::cout << "Data size: " << newData.size() << " bytes" << std::endl;
+    for (size_t i = 0; i < idat_data.size(); i++) {
+        if (!writeChunk(file, static_cast<uint32_t>(ChunkType::IDAT), idat_data[i])) {
+            return fail("Failed to write IDAT chunk");
+        }
+        compressedSize += idat_data[i].size();
+    }
+    BufferPool::shared().release(filtered);
+
+    if (!writeChunk(file, static_cast<uint32_t>(ChunkType::IEND), std::vector<uint8_t>())) {
+        return fail("Failed to write IEND chunk");
+    }
 
+    timer.setBytes(pixels.size, compressedSize);
     return true;
 }
 
@@ -131,70 +271,436 @@ std::string PNGImage::checkPNGExtension(const std::string& filename) {
     return filename + ".png";
 }
 
-bool PNGImage::readChunk(std::ifstream& file, PNGChunk& chunk) {
-    unsigned char lenBytes[4];
-    file.read(reinterpret_cast<char*>(lenBytes), 4);
-    if (file.eof()) return false;
-    
-    chunk.length = (lenBytes[0] << 24) | (lenBytes[1] << 16) | 
-                  (lenBytes[2] << 8) | lenBytes[3];
+bool PNGImage::readChunkTable(ByteSpan file, std::vector<PNGChunkView>& chunks) {
+    ScopedTimer timer(Stage::PNG_CHUNKS);
+    size_t pos = 8;
 
-    unsigned char typeBytes[4];
-    file.read(reinterpret_cast<char*>(typeBytes), 4);
-    chunk.type = (typeBytes[0] << 24) | (typeBytes[1] << 16) | 
-                 (typeBytes[2] << 8) | typeBytes[3];
-    
-    chunk.data.resize(chunk.length);
-    if (chunk.length > 0) {
-        file.read(reinterpret_cast<char*>(chunk.data.data()), chunk.length);
+    while (file.size - pos >= 12) {
+        const uint8_t* header = file.data + pos;
+        PNGChunkView chunk;
+        chunk.length = readBigEndian32(header);
+        chunk.type = readBigEndian32(header + 4);
+        chunk.offset = pos + 8;
+
+        if (chunk.length > file.size - pos - 12) {
+            // Truncated file: keep the complete chunks seen so far.
+            break;
+        }
+        chunk.crc = readBigEndian32(header + 8 + chunk.length);
+
+        // Type and data are contiguous in the mapping, so one pass covers both.
+        if (CRC32::update(0, header + 4, chunk.length + 4) != chunk.crc) {
+            return fail("CRC mismatch in chunk");
+        }
+
+        chunks.push_back(chunk);
+        pos += 12 + static_cast<size_t>(chunk.length);
+
+        if (chunk.type == static_cast<uint32_t>(ChunkType::IEND)) {
+            break;
+        }
     }
-    
-    unsigned char crcBytes[4];
-    file.read(reinterpret_cast<char*>(crcBytes), 4);
-    chunk.crc = (crcBytes[0] << 24) | (crcBytes[1] << 16) | 
-                (crcBytes[2] << 8) | crcBytes[3];
-    
-    return file.good();
+
+    timer.setBytes(pos, pos);
+    Stats::add(Counter::PNG_CHUNKS, chunks.size());
+    return true;
 }
 
-bool PNGImage::processIHDR(const std::vector<uint8_t>& data) {
-    if (data.size() < 13) {
-        std::cout << "Error: Invalid IHDR chunk size" << std::endl;
-        return false;
+bool PNGImage::processIHDR(const uint8_t* data, size_t size) {
+    if (size < 13) {
+        return fail("Invalid IHDR chunk size");
     }
 
     width = (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
     height = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
     bitDepth = data[8];
     uint8_t colorType = data[9];
+    uint8_t interlaceMethod = data[12];
     
-    if (width == 0 || height == 0) {
-        std::cout << "Error: Invalid dimensions" << std::endl;
+    if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+        return fail("Invalid dimensions");
+    }
+
+    if (interlaceMethod > 1) {
+        return fail("Unknown interlace method " + std::to_string(interlaceMethod));
+    }
+
+    if (!PixelFormat::isValid(colorType, bitDepth)) {
+        return fail("Invalid bit depth " + std::to_string(bitDepth) +
+                    " for color type " + std::to_string(colorType));
+    }
+
+    // Until the image data is decoded, channels and bit depth describe the
+    // samples of the file, so rowBytes() is the scanline size.
+    this->colorType = static_cast<ColorType>(colorType);
+    interlaced = interlaceMethod == 1;
+    channels = PixelFormat::samplesPerPixel(colorType);
+    palette.clear();
+    paletteEntries = 0;
+    transparentPalette = false;
+    return true;
+}
+
+bool PNGImage::processPLTE(const uint8_t* data, size_t size) {
+    // A palette is only a suggestion for truecolor images and is ignored.
+    if (colorType != ColorType::PALETTE) {
+        return true;
+    }
+
+    size_t entries = size / 3;
+    if (size % 3 != 0 || entries == 0 || entries > (static_cast<size_t>(1) << bitDepth)) {
+        return fail("Invalid PLTE chunk size");
+    }
+
+    // Indices past the last entry decode as opaque black.
+    palette.assign(PixelFormat::PALETTE_SIZE * 4, 0);
+    for (size_t i = 0; i < PixelFormat::PALETTE_SIZE; i++) {
+        palette[i * 4 + 3] = 255;
+    }
+    for (size_t i = 0; i < entries; i++) {
+        palette[i * 4] = data[i * 3];
+        palette[i * 4 + 1] = data[i * 3 + 1];
+        palette[i * 4 + 2] = data[i * 3 + 2];
+    }
+    paletteEntries = entries;
+    return true;
+}
+
+bool PNGImage::processTRNS(const uint8_t* data, size_t size) {
+    // A transparent gray level or color of a truecolor image is not turned
+    // into an alpha channel; those pixels stay opaque.
+    if (colorType != ColorType::PALETTE) {
+        return true;
+    }
+
+    // The table always holds 256 entries; tRNS may not go past those PLTE defined.
+    if (palette.empty() || size > paletteEntries) {
+        return fail("Invalid tRNS chunk");
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        palette[i * 4 + 3] = data[i];
+        transparentPalette = transparentPalette || data[i] != 255;
+    }
+    return true;
+}
+
+bool PNGImage::selectFormat(PixelFormat::Kernels& format) {
+    if (colorType == ColorType::PALETTE && palette.empty()) {
+        return fail("No PLTE chunk found");
+    }
+    if (!PixelFormat::select(static_cast<uint8_t>(colorType), bitDepth, transparentPalette, format)) {
+        return fail("Unsupported pixel format");
+    }
+
+    // From here on the image describes the decoded pixels.
+    colorType = format.decodedType;
+    channels = format.decodedChannels;
+    bitDepth = format.decodedBitDepth;
+    return true;
+}
+
+size_t PNGImage::bytesPerPixel() const {
+    size_t bits = static_cast<size_t>(channels) * bitDepth;
+    return bits >= 8 ? bits / 8 : 1;
+}
+
+size_t PNGImage::rowBytes() const {
+    return (static_cast<size_t>(width) * channels * bitDepth + 7) / 8;
+}
+
+bool PNGImage::decodeImageData(const std::vector<ByteSpan>& idatSpans, const ProgressCallback& progress) {
+    PixelFormat::Kernels format;
+    if (!selectFormat(format)) {
         return false;
     }
 
-    switch (colorType) {
-        case 0:
-            this->colorType = ColorType::GRAYSCALE;
-            channels = 1;
-            break;
-        case 2:
-            this->colorType = ColorType::RGB;
-            channels = 3;
-            break;
-        case 6:
-            this->colorType = ColorType::RGBA;
-            channels = 4;
-            break;
-        default:
-            this->colorType = ColorType::RGB;
-            channels = 3;
-            break;
+    size_t maxSize = std::numeric_limits<size_t>::max();
+    size_t pixelBits = std::max<size_t>(format.samples * format.bitDepth,
+                                        format.decodedChannels * format.decodedBitDepth);
+    if (width > (maxSize - 7) / pixelBits) {
+        return fail("Image dimensions are too large");
+    }
+    size_t stride = format.scanlineBytes(width);
+    size_t pixelStride = format.decodedRowBytes(width);
+    if (height > maxSize / (std::max(stride, pixelStride) + 1)) {
+        return fail("Image dimensions are too large");
+    }
+
+    Inflater inflater;
+    size_t compressedSize = 0;
+    for (size_t i = 0; i < idatSpans.size(); i++) {
+        inflater.addInput(idatSpans[i].data, idatSpans[i].size);
+        compressedSize += idatSpans[i].size;
+    }
+
+    // Nothing is allocated for dimensions the image data cannot possibly
+    // fill, so a tiny file claiming a huge image fails here. Interlacing
+    // changes the size by a few filter bytes, well inside the bound.
+    size_t filteredSize = (stride + 1) * height;
+    if (filteredSize / MAX_INFLATE_RATIO > compressedSize) {
+        return fail("Image data is too short for " + std::to_string(width) + "x" +
+                    std::to_string(height) + " pixels");
+    }
+
+    if (interlaced) {
+        return decodeInterlaced(format, inflater, progress);
+    }
+
+    // Inflate every scanline, filter byte included, straight into the pixel
+    // buffer; the rows are then unfiltered and compacted in place.
+    allocateData(filteredSize);
+
+    ScopedTimer inflateTimer(Stage::PNG_INFLATE);
+
+    size_t produced = 0;
+    bool inflated = inflater.inflate(data.data(), filteredSize, produced);
+    inflateTimer.setBytes(compressedSize, produced);
+    if (!inflated) {
+        return fail("Failed to decompress image data: " + inflater.getError());
+    }
+    if (produced != filteredSize) {
+        fail("Image data is truncated");
+        std::cout << "Expected: " << filteredSize << " bytes" << std::endl;
+        std::cout << "Decoded: " << produced << " bytes" << std::endl;
+        return false;
     }
 
+    if (!unfilterScanlines(format)) {
+        return false;
+    }
+    if (format.unpack) {
+        unpackScanlines(format);
+    } else {
+        data.resize(stride * height);
+    }
     return true;
 }
 
+bool PNGImage::decodeIDAT(ByteSpan stream, uint32_t newWidth, uint32_t newHeight, uint8_t newChannels) {
+    // A bare zlib stream of filtered 8-bit scanlines, as the first version 1
+    // .samet files stored it.
+    error.clear();
+    width = newWidth;
+    height = newHeight;
+    channels = newChannels;
+    bitDepth = 8;
+    interlaced = false;
+    palette.clear();
+    paletteEntries = 0;
+    transparentPalette = false;
+    if (!PixelFormat::colorTypeFor(channels, bitDepth, colorType)) {
+        return fail("Unsupported channel count " + std::to_string(channels));
+    }
+
+    std::vector<ByteSpan> spans(1, stream);
+    return decodeImageData(spans, ProgressCallback());
+}
+
+bool PNGImage::decodeInterlaced(const PixelFormat::Kernels& format, Inflater& inflater,
+                                const ProgressCallback& progress) {
+    // The seven reduced images follow each other in the stream, each a
+    // complete filtered image of its own; empty passes have no bytes at all.
+    uint32_t passWidth[ADAM7_PASSES];
+    uint32_t passHeight[ADAM7_PASSES];
+    size_t passOffset[ADAM7_PASSES + 1] = {0};
+    for (int p = 0; p < ADAM7_PASSES; p++) {
+        passWidth[p] = passExtent(width, ADAM7[p].xStart, ADAM7[p].xShift);
+        passHeight[p] = passExtent(height, ADAM7[p].yStart, ADAM7[p].yShift);
+        size_t size = passWidth[p] == 0 ? 0 : (format.scanlineBytes(passWidth[p]) + 1) * passHeight[p];
+        passOffset[p + 1] = passOffset[p] + size;
+    }
+
+    BufferPool& pool = BufferPool::shared();
+    std::vector<uint8_t> scanlines = pool.acquire(passOffset[ADAM7_PASSES]);
+    size_t pixelStride = format.decodedRowBytes(width);
+    std::vector<uint8_t> pixels = pool.acquire(pixelStride * height);
+    if (format.decodedChannels * format.decodedBitDepth < 8) {
+        // Packed pixels are merged into their bytes; keep the row padding zero.
+        std::fill(pixels.begin(), pixels.end(), 0);
+    }
+
+    auto inflatePass = [&](int p) {
+        ScopedTimer timer(Stage::PNG_INFLATE);
+        size_t size = passOffset[p + 1] - passOffset[p];
+        size_t produced = 0;
+        bool ok = size == 0 || inflater.read(scanlines.data() + passOffset[p], size, produced);
+        timer.setBytes(0, produced);
+        return ok && produced == size;
+    };
+
+    // Unfilters one pass in place and scatters its rows into the image with
+    // the kernel for its column step.
+    auto expandPass = [&](int p) {
+        if (passOffset[p + 1] == passOffset[p]) {
+            return true;
+        }
+        ScopedTimer timer(Stage::PNG_UNFILTER);
+        const Adam7Pass& pass = ADAM7[p];
+        size_t stride = format.scanlineBytes(passWidth[p]);
+        std::vector<uint8_t> zeroRow(stride, 0);
+        std::vector<uint8_t> unpacked(format.unpack ? format.decodedRowBytes(passWidth[p]) : 0);
+        const uint8_t* prior = zeroRow.data();
+
+        for (uint32_t y = 0; y < passHeight[p]; y++) {
+            uint8_t* filtered = scanlines.data() + passOffset[p] + y * (stride + 1);
+            uint8_t* row = filtered + 1;
+            if (!PNGFilter::unfilterRow(format.unfilter, filtered[0], row, prior, stride)) {
+                return false;
+            }
+            prior = row;
+
+            const uint8_t* source = row;
+            if (format.unpack) {
+                format.unpack(row, unpacked.data(), passWidth[p], palette.data());
+                source = unpacked.data();
+            }
+            size_t imageRow = pass.yStart + (static_cast<size_t>(y) << pass.yShift);
+            format.scatter[pass.xShift](source, pixels.data() + imageRow * pixelStride,
+                                        passWidth[p], pass.xStart);
+        }
+        timer.setBytes(passOffset[p + 1] - passOffset[p], stride * passHeight[p]);
+        return true;
+    };
+
+    // While one pass is unfiltered the next one is inflated on another thread.
+    bool inflated = inflatePass(0);
+    bool expanded = true;
+    for (int p = 0; p < ADAM7_PASSES && inflated && expanded; p++) {
+        bool nextInflated = true;
+        ThreadPool::shared().parallelFor(2, 1, [&](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; task++) {
+                if (task == 0) {
+                    nextInflated = p + 1 == ADAM7_PASSES || inflatePass(p + 1);
+                } else {
+                    expanded = expandPass(p);
+                }
+            }
+        });
+        inflated = nextInflated;
+
+        if (!expanded || !progress || p + 1 == ADAM7_PASSES || passOffset[p + 1] == passOffset[p]) {
+            continue;
+        }
+
+        // Collect the grid known so far into a reduced image.
+        unsigned xShift = PREVIEW_SHIFT[p][0];
+        unsigned yShift = PREVIEW_SHIFT[p][1];
+        Preview preview;
+        preview.pass = p + 1;
+        preview.xStep = 1u << xShift;
+        preview.yStep = 1u << yShift;
+        preview.width = passExtent(width, 0, xShift);
+        preview.height = passExtent(height, 0, yShift);
+        preview.channels = format.decodedChannels;
+        preview.bitDepth = format.decodedBitDepth;
+        size_t previewStride = format.decodedRowBytes(preview.width);
+        std::vector<uint8_t> reduced(previewStride * preview.height, 0);
+        ThreadPool::shared().parallelFor(preview.height, 64, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++) {
+                format.gather[xShift](pixels.data() + (y << yShift) * pixelStride,
+                                      reduced.data() + y * previewStride, preview.width, 0);
+            }
+        });
+        preview.pixels = {reduced.data(), reduced.size()};
+
+        if (!progress(preview)) {
+            width = preview.width;
+            height = preview.height;
+            setData(std::move(reduced));
+            pool.release(pixels);
+            pool.release(scanlines);
+            return true;
+        }
+    }
+    pool.release(scanlines);
+
+    if (!expanded) {
+        pool.release(pixels);
+        return fail("Invalid filter type in interlaced image data");
+    }
+    if (!inflated) {
+        pool.release(pixels);
+        if (!inflater.getError().empty()) {
+            return fail("Failed to decompress image data: " + inflater.getError());
+        }
+        return fail("Image data is truncated");
+    }
+
+    setData(std::move(pixels));
+    return true;
+}
+
+bool PNGImage::fail(const std::string& message) {
+    std::cout << "Error: " << message << std::endl;
+    // The first message names the cause; later ones come from the callers
+    // giving up in turn.
+    if (error.empty()) {
+        error = message;
+    }
+    return false;
+}
+
+void PNGImage::allocateData(size_t size) {
+    // The old pixels are dead at this point, so trade the buffer for a pooled
+    // one of the right class instead of growing it and copying its contents.
+    if (data.capacity() < size) {
+        BufferPool::shared().release(data);
+        data = BufferPool::shared().acquire(size);
+    } else {
+        data.resize(size);
+    }
+}
+
+bool PNGImage::unfilterScanlines(const PixelFormat::Kernels& format) {
+    ScopedTimer timer(Stage::PNG_UNFILTER);
+    size_t stride = format.scanlineBytes(width);
+    std::vector<uint8_t> zeroRow(stride, 0);
+    const uint8_t* prior = zeroRow.data();
+
+    for (size_t y = 0; y < height; y++) {
+        uint8_t* row = data.data() + y * stride;
+        const uint8_t* filtered = data.data() + y * (stride + 1);
+        uint8_t filterType = filtered[0];
+
+        std::memmove(row, filtered + 1, stride);
+        if (!PNGFilter::unfilterRow(format.unfilter, filterType, row, prior, stride)) {
+            return fail("Invalid filter type " + std::to_string(filterType) + " on row " + std::to_string(y));
+        }
+        prior = row;
+    }
+
+    timer.setBytes((stride + 1) * height, stride * height);
+    return true;
+}
+
+void PNGImage::unpackScanlines(const PixelFormat::Kernels& format) {
+    size_t stride = format.scanlineBytes(width);
+    size_t pixelStride = format.decodedRowBytes(width);
+    std::vector<uint8_t> pixels = BufferPool::shared().acquire(pixelStride * height);
+
+    // Rows are independent once unfiltered.
+    const uint8_t* scanlines = data.data();
+    ThreadPool::shared().parallelFor(height, 64, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++) {
+            format.unpack(scanlines + y * stride, pixels.data() + y * pixelStride, width, palette.data());
+        }
+    });
+    setData(std::move(pixels));
+}
+
+std::vector<uint8_t> PNGImage::filterScanlines(const uint8_t* pixels) {
+    ScopedTimer timer(Stage::PNG_FILTER);
+    size_t stride = rowBytes();
+    std::vector<uint8_t> filtered = BufferPool::shared().acquire((stride + 1) * height);
+
+    FilterSelector selector(filterStrategy);
+    selector.filterImage(pixels, stride, height, bytesPerPixel(), filtered.data());
+
+    timer.setBytes(stride * height, filtered.size());
+    return filtered;
+}
+
 std::vector<uint8_t> PNGImage::createIHDR() {
     std::vector<uint8_t> ihdr(13);
     
@@ -217,68 +723,7 @@ std::vector<uint8_t> PNGImage::createIHDR() {
     return ihdr;
 }
 
-std::vector<uint8_t> PNGImage::compressData() {
-    std::vector<uint8_t> compressed;
-    size_t i = 0;
-    
-    while (i < data.size()) {
-        uint8_t currentByte = data[i];
-        size_t count = 1;
-        
-        while (i + count < data.size() && data[i + count] == currentByte && count < 255) {
-            count++;
-        }
-            
-        if (count >= 4) {
-            compressed.push_back(0xFF);
-            compressed.push_back(currentByte);
-            compressed.push_back(count);
-            i += count;
-        } else {
-            size_t nonRepeatCount = 1;
-            while (i + nonRepeatCount < data.size() && 
-                   nonRepeatCount < 255 && 
-                   (i + nonRepeatCount + 2 >= data.size() || 
-                    data[i + nonRepeatCount] != data[i + nonRepeatCount + 1] || 
-                    data[i + nonRepeatCount] != data[i + nonRepeatCount + 2])) {
-                nonRepeatCount++;
-            }
-                
-            compressed.push_back(nonRepeatCount - 1);
-            for (size_t j = 0; j < nonRepeatCount; j++) {
-                compressed.push_back(data[i + j]);
-            }
-            i += nonRepeatCount;
-        }
-    }
-        
-    return compressed;
-}
-
-std::vector<uint8_t> PNGImage::decompressData(const std::vector<uint8_t>& compressed) {
-    std::vector<uint8_t> decompressed;
-    size_t i = 0;
-        
-    while (i < compressed.size()) {
-        uint8_t control = compressed[i++];
-        
-        if (control == 0xFF) {
-            uint8_t value = compressed[i++];
-            uint8_t count = compressed[i++];
-            decompressed.insert(decompressed.end(), count, value);
-        } else {
-            uint8_t count = control + 1;
-            decompressed.insert(decompressed.end(), 
-                              compressed.begin() + i, 
-                              compressed.begin() + i + count);
-            i += count;
-        }
-    }
-    
-    return decompressed;
-}
-
-bool PNGImage::writeChunk(std::ofstream& file, uint32_t type, const std::vector<uint8_t>& chunkData) {
+bool PNGImage::writeChunk(std::ostream& file, uint32_t type, const std::vector<uint8_t>& chunkData) {
     // Write length
     uint32_t length = chunkData.size();
     unsigned char lenBytes[4] = {
@@ -304,7 +749,7 @@ bool PNGImage::writeChunk(std::ofstream& file, uint32_t type, const std::vector<
     }
 
     // Calculate and write CRC
-    uint32_t crc = PNGChunk::calculateCRC(chunkData);
+    uint32_t crc = PNGChunk::calculateCRC(type, chunkData);
     unsigned char crcBytes[4] = {
         static_cast<unsigned char>((crc >> 24) & 0xFF),
         static_cast<unsigned char>((crc >> 16) & 0xFF),
@@ -1,9 +1,13 @@
 #ifndef PNG_IMAGE_H
 #define PNG_IMAGE_H
 
+#include <functional>
+#include <iosfwd>
 #include <vector>
 #include <string>
 #include "PNGStructs.h"
+#include "PixelFormat.h"
+#include "FilterSelector.h"
 
 /**
  * @file PNGImage.h
@@ -12,7 +16,33 @@
  * @date 2025
  */
 
+class Inflater;
+
 class PNGImage {
+public:
+    /**
+     * @brief Reduced image handed to a progress callback while an interlaced file decodes
+     *
+     * After Adam7 pass n every pixel whose column is a multiple of xStep and
+     * whose row is a multiple of yStep is known; the preview holds exactly
+     * those, from 1/8 x 1/8 of the size after pass 1 to 1 x 1/2 after pass 6.
+     */
+    struct Preview {
+        int pass;               // passes decoded so far, 1 to 6
+        uint32_t xStep;
+        uint32_t yStep;
+        uint32_t width;
+        uint32_t height;
+        uint8_t channels;
+        uint8_t bitDepth;
+        ByteSpan pixels;        // valid during the callback only
+    };
+
+    /**
+     * @brief Receives previews; returning false stops decoding and keeps the preview
+     */
+    typedef std::function<bool(const Preview&)> ProgressCallback;
+
 private:
     std::vector<uint8_t> data;
     uint32_t width;
@@ -20,13 +50,33 @@ private:
     uint8_t channels;
     uint8_t bitDepth;
     ColorType colorType;
+    bool interlaced;
+    FilterStrategy filterStrategy;
+    std::vector<uint8_t> palette;   // RGBA entries from PLTE and tRNS, empty without PLTE
+    size_t paletteEntries;          // entries the PLTE chunk actually defines
+    bool transparentPalette;
+    std::string error;
 
-    bool writeChunk(std::ofstream& file, uint32_t type, const std::vector<uint8_t>& chunkData);
-    bool readChunk(std::ifstream& file, PNGChunk& chunk);
+    bool writeChunk(std::ostream& file, uint32_t type, const std::vector<uint8_t>& chunkData);
+    bool readChunkTable(ByteSpan file, std::vector<PNGChunkView>& chunks);
+    bool prepareSave(ByteSpan pixels, uint32_t newWidth, uint32_t newHeight, uint8_t newChannels);
+    bool writeImage(std::ostream& file, ByteSpan pixels, int compressionLevel, size_t& compressedSize);
     std::vector<uint8_t> createIHDR();
-    bool processIHDR(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> compressData();
-    std::vector<uint8_t> decompressData(const std::vector<uint8_t>& compressed);
+    bool processIHDR(const uint8_t* data, size_t size);
+    bool processPLTE(const uint8_t* data, size_t size);
+    bool processTRNS(const uint8_t* data, size_t size);
+    bool selectFormat(PixelFormat::Kernels& format);
+    bool decodeImageData(const std::vector<ByteSpan>& idatSpans, const ProgressCallback& progress);
+    bool decodeIDAT(ByteSpan stream, uint32_t newWidth, uint32_t newHeight, uint8_t newChannels);
+    bool decodeInterlaced(const PixelFormat::Kernels& format, Inflater& inflater,
+                          const ProgressCallback& progress);
+    bool unfilterScanlines(const PixelFormat::Kernels& format);
+    void unpackScanlines(const PixelFormat::Kernels& format);
+    std::vector<uint8_t> filterScanlines(const uint8_t* pixels);
+    bool fail(const std::string& message);
+    void allocateData(size_t size);
+    size_t bytesPerPixel() const;
+    size_t rowBytes() const;
 
 public:
     /**
@@ -34,37 +84,116 @@ public:
      */
     PNGImage();
 
+    /**
+     * @brief Destructor, hands the pixel buffer back to the shared BufferPool
+     */
+    ~PNGImage();
+
+    PNGImage(const PNGImage&) = default;
+    PNGImage(PNGImage&&) = default;
+    PNGImage& operator=(const PNGImage&) = default;
+    PNGImage& operator=(PNGImage&&) = default;
+
     // Getters
     const std::vector<uint8_t>& getData() const { return data; }
+    ByteSpan getPixels() const { return {data.data(), data.size()}; }
     uint32_t getWidth() const { return width; }
     uint32_t getHeight() const { return height; }
     uint8_t getChannels() const { return channels; }
+    uint8_t getBitDepth() const { return bitDepth; }
+
+    /**
+     * @brief Returns a description of the first error of the last read, decode or save
+     */
+    const std::string& getError() const { return error; }
 
     // Setters
     void setWidth(uint32_t w) { width = w; }
     void setHeight(uint32_t h) { height = h; }
     void setChannels(uint8_t c) { channels = c; }
+    void setBitDepth(uint8_t depth) { bitDepth = depth; }
     void resizeData(size_t size) { data.resize(size); }
     void setData(const std::vector<uint8_t>& newData) { data = newData; }
+    void setData(std::vector<uint8_t>&& newData);
+
+    /**
+     * @brief Moves the pixel buffer out of the image, leaving it empty
+     * @return The pixel data
+     */
+    std::vector<uint8_t> takeData();
+    void setFilterStrategy(FilterStrategy strategy) { filterStrategy = strategy; }
 
     /**
      * @brief Reads a PNG file
+     *
+     * Every color type and bit depth is accepted. Palette images are expanded
+     * to 8-bit RGB, or RGBA when tRNS makes an entry translucent; all others
+     * keep their samples as stored, packed below 8 bits and big-endian at 16.
+     *
+     * Interlaced files report a preview to progress after each of the first
+     * six Adam7 passes that hold pixels. If the callback returns false, decoding
+     * stops and the image becomes that preview, with its smaller width and height.
      * @param filename Path to the PNG file
+     * @param progress Optional preview callback, called on the calling thread
      * @return true if successful, false otherwise
      */
-    bool readPNG(const std::string& filename);
+    bool readPNG(const std::string& filename, const ProgressCallback& progress = ProgressCallback());
+
+    /**
+     * @brief Decodes a PNG file already read into memory
+     * @param file Contents of the whole file, which must outlive the call only
+     * @param progress Optional preview callback, see readPNG()
+     * @return true if successful, false otherwise
+     */
+    bool decodePNG(ByteSpan file, const ProgressCallback& progress = ProgressCallback());
 
     /**
      * @brief Saves data as a PNG file
+     *
+     * Scanlines beyond one deflate segment are compressed in parallel and
+     * written as one IDAT chunk per segment. Samples have getBitDepth() bits,
+     * in the layout readPNG() produces.
      * @param filename Output file path
      * @param newData Image data to save
      * @param newWidth Image width
      * @param newHeight Image height
-     * @param newChannels Number of color channels
+     * @param newChannels 1 gray, 2 gray+alpha, 3 RGB or 4 RGBA
+     * @param compressionLevel Deflate effort, 0 (stored) and 1 (fastest) to 9 (smallest)
      * @return true if successful, false otherwise
      */
     bool savePNG(const std::string& filename, const std::vector<uint8_t>& newData,
-                 uint32_t newWidth, uint32_t newHeight, uint8_t newChannels);
+                 uint32_t newWidth, uint32_t newHeight, uint8_t newChannels,
+                 int compressionLevel = 6);
+
+    /**
+     * @brief Saves pixels from any buffer as a PNG file without copying them
+     * @param filename Output file path
+     * @param pixels Image data to save
+     * @param newWidth Image width
+     * @param newHeight Image height
+     * @param newChannels 1 gray, 2 gray+alpha, 3 RGB or 4 RGBA
+     * @param compressionLevel Deflate effort, 0 (stored) and 1 (fastest) to 9 (smallest)
+     * @return true if successful, false otherwise
+     */
+    bool savePNG(const std::string& filename, ByteSpan pixels,
+                 uint32_t newWidth, uint32_t newHeight, uint8_t newChannels,
+                 int compressionLevel = 6);
+
+    /**
+     * @brief Encodes pixels as a PNG file into a stream instead of a file
+     *
+     * Lets a pipeline encode into memory and leave the writing to another stage.
+     * @param out Output stream
+     * @param pixels Image data to save
+     * @param newWidth Image width
+     * @param newHeight Image height
+     * @param newChannels 1 gray, 2 gray+alpha, 3 RGB or 4 RGBA
+     * @param compressionLevel Deflate effort, 0 (stored) and 1 (fastest) to 9 (smallest)
+     * @return true if successful, false otherwise
+     */
+    bool writePNG(std::ostream& out, ByteSpan pixels,
+                  uint32_t newWidth, uint32_t newHeight, uint8_t newChannels,
+                  int compressionLevel = 6);
 
     /**
      * @brief Ensures filename has .png extension
@@ -74,6 +203,7 @@ public:
     std::string checkPNGExtension(const std::string& filename);
 
     friend class ImageCompressor;
+    friend class PNGRowReader;
 };
 
 #endif // PNG_IMAGE_H 
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "PNGRowReader.h"
+#include "CRC32.h"
+#include <iostream>
+#include <algorithm>
+
+/**
+ * @file PNGRowReader.cpp
+ * @brief Implementation of the PNGRowReader class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+// Size of the buffer the IDAT payloads are streamed through.
+const size_t INPUT_BUFFER_SIZE = 65536;
+
+// Largest IHDR, PLTE and tRNS chunks the specification allows, the only
+// chunks the reader reads into memory.
+const uint32_t IHDR_SIZE = 13;
+const uint32_t MAX_PLTE_SIZE = 3 * PixelFormat::PALETTE_SIZE;
+const uint32_t MAX_TRNS_SIZE = PixelFormat::PALETTE_SIZE;
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+inline uint32_t typeCRC(uint32_t type) {
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(type >> 24), static_cast<uint8_t>(type >> 16),
+        static_cast<uint8_t>(type >> 8), static_cast<uint8_t>(type)
+    };
+    return CRC32::update(0, bytes, 4);
+}
+
+} // namespace
+
+PNGRowReader::PNGRowReader()
+    : chunkRemaining(0), chunkCRC(0), currentRow(0), inImageData(false), failed(false) {}
+
+bool PNGRowReader::open(const std::string& filename) {
+    close();
+
+    file.open(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return fail("Cannot open file " + filename);
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    uint8_t signature[8];
+    file.read(reinterpret_cast<char*>(signature), 8);
+    if (file.gcount() != 8 || !std::equal(signature, signature + 8, PNGSignature::data)) {
+        return fail("Invalid PNG signature - File is not a PNG image");
+    }
+
+    // Walk the chunks in front of the image data. IHDR, PLTE and tRNS are
+    // small and read whole so their CRC can be checked before they are used;
+    // everything else is skipped unread, so no length field decides how much
+    // memory the reader takes.
+    bool foundIHDR = false;
+    uint8_t chunkData[MAX_PLTE_SIZE];
+    for (;;) {
+        uint32_t length, type;
+        if (!readChunkHeader(length, type)) {
+            return fail("No image data found (no IDAT chunks)");
+        }
+
+        if (type == static_cast<uint32_t>(ChunkType::IDAT)) {
+            if (!foundIHDR) {
+                return fail("No IHDR chunk found");
+            }
+            chunkRemaining = length;
+            chunkCRC = typeCRC(type);
+            inImageData = true;
+            break;
+        }
+        if (type == static_cast<uint32_t>(ChunkType::IEND)) {
+            return fail("No image data found (no IDAT chunks)");
+        }
+
+        // The data and the CRC must fit in the rest of the file.
+        uint64_t position = static_cast<uint64_t>(file.tellg());
+        if (position > fileSize || static_cast<uint64_t>(length) + 4 > fileSize - position) {
+            return fail("Truncated chunk");
+        }
+
+        uint32_t limit = 0;
+        if (type == static_cast<uint32_t>(ChunkType::IHDR)) {
+            limit = IHDR_SIZE;
+        } else if (type == static_cast<uint32_t>(ChunkType::PLTE) && foundIHDR) {
+            limit = MAX_PLTE_SIZE;
+        } else if (type == static_cast<uint32_t>(ChunkType::TRNS) && foundIHDR) {
+            limit = MAX_TRNS_SIZE;
+        } else {
+            file.seekg(static_cast<std::streamoff>(length) + 4, std::ios::cur);
+            continue;
+        }
+        if (length > limit) {
+            return fail("Chunk is larger than the specification allows");
+        }
+
+        file.read(reinterpret_cast<char*>(chunkData), length);
+        if (static_cast<uint32_t>(file.gcount()) != length) {
+            return fail("Truncated chunk");
+        }
+        chunkCRC = CRC32::update(typeCRC(type), chunkData, length);
+        if (!finishChunk()) {
+            return false;
+        }
+
+        if (type == static_cast<uint32_t>(ChunkType::IHDR)) {
+            if (!header.processIHDR(chunkData, length)) {
+                return fail("Failed to process IHDR chunk");
+            }
+            if (header.interlaced) {
+                // Adam7 rows are only complete once the last pass is decoded.
+                return fail("Interlaced PNG images cannot be read row by row");
+            }
+            foundIHDR = true;
+        } else if (type == static_cast<uint32_t>(ChunkType::PLTE) && foundIHDR) {
+            if (!header.processPLTE(chunkData, length)) {
+                return fail("Failed to process PLTE chunk");
+            }
+        } else if (type == static_cast<uint32_t>(ChunkType::TRNS) && foundIHDR) {
+            if (!header.processTRNS(chunkData, length)) {
+                return fail("Failed to process tRNS chunk");
+            }
+        }
+    }
+
+    // PLTE and tRNS precede the image data, so the format is known now and the
+    // header switches to describing the decoded rows.
+    if (!header.selectFormat(format)) {
+        return fail("Failed to select the pixel format");
+    }
+
+    // One scanline with its filter byte for the row being decoded and one for
+    // the prior row; the prior of the first row is all zeros.
+    size_t stride = format.scanlineBytes(header.width);
+    current.assign(stride + 1, 0);
+    previous.assign(stride + 1, 0);
+    if (format.unpack) {
+        unpacked.resize(header.rowBytes());
+    }
+    input.resize(INPUT_BUFFER_SIZE);
+
+    inflater.reset();
+    inflater.setInputProvider([this](const uint8_t*& data, size_t& size) {
+        return nextInput(data, size);
+    });
+    return true;
+}
+
+void PNGRowReader::close() {
+    if (file.is_open()) {
+        file.close();
+    }
+    file.clear();
+    inflater.reset();
+    std::vector<uint8_t>().swap(input);
+    std::vector<uint8_t>().swap(current);
+    std::vector<uint8_t>().swap(previous);
+    std::vector<uint8_t>().swap(unpacked);
+    header.width = 0;
+    header.height = 0;
+    chunkRemaining = 0;
+    chunkCRC = 0;
+    currentRow = 0;
+    inImageData = false;
+    failed = false;
+    header.error.clear();
+    error.clear();
+}
+
+bool PNGRowReader::nextRow(ByteSpan& row) {
+    if (failed || currentRow >= header.height) {
+        return false;
+    }
+
+    size_t produced = 0;
+    if (!inflater.read(current.data(), current.size(), produced)) {
+        // An I/O or CRC problem has already been reported by nextInput().
+        return failed ? false : fail("Failed to decompress image data: " + inflater.getError());
+    }
+    if (produced != current.size()) {
+        return fail("Image data is truncated at row " + std::to_string(currentRow));
+    }
+
+    size_t stride = current.size() - 1;
+    uint8_t filterType = current[0];
+    if (!PNGFilter::unfilterRow(format.unfilter, filterType, current.data() + 1, previous.data() + 1, stride)) {
+        return fail("Invalid filter type " + std::to_string(filterType) +
+                    " on row " + std::to_string(currentRow));
+    }
+
+    // The decoded row becomes the prior row of the next one; swapping keeps the
+    // returned view valid until the next call.
+    current.swap(previous);
+    if (format.unpack) {
+        format.unpack(previous.data() + 1, unpacked.data(), header.width, header.palette.data());
+        row.data = unpacked.data();
+        row.size = unpacked.size();
+    } else {
+        row.data = previous.data() + 1;
+        row.size = stride;
+    }
+    currentRow++;
+
+    // The CRC of the last IDAT is only known once its payload is exhausted.
+    if (currentRow == header.height && inImageData && chunkRemaining == 0) {
+        inImageData = false;
+        return finishChunk();
+    }
+    return true;
+}
+
+bool PNGRowReader::readChunkHeader(uint32_t& length, uint32_t& type) {
+    uint8_t bytes[8];
+    file.read(reinterpret_cast<char*>(bytes), 8);
+    if (file.gcount() != 8) {
+        return false;
+    }
+    length = readBigEndian32(bytes);
+    type = readBigEndian32(bytes + 4);
+    return true;
+}
+
+bool PNGRowReader::finishChunk() {
+    uint8_t bytes[4];
+    file.read(reinterpret_cast<char*>(bytes), 4);
+    if (file.gcount() != 4) {
+        return fail("Truncated chunk");
+    }
+    if (readBigEndian32(bytes) != chunkCRC) {
+        return fail("CRC mismatch in chunk");
+    }
+    return true;
+}
+
+bool PNGRowReader::nextInput(const uint8_t*& data, size_t& size) {
+    while (chunkRemaining == 0) {
+        if (!inImageData || failed) {
+            return false;
+        }
+        if (!finishChunk()) {
+            return false;
+        }
+        // IDAT chunks must be consecutive; anything else ends the image data.
+        uint32_t length, type;
+        if (!readChunkHeader(length, type) || type != static_cast<uint32_t>(ChunkType::IDAT)) {
+            inImageData = false;
+            return false;
+        }
+        chunkRemaining = length;
+        chunkCRC = typeCRC(type);
+    }
+
+    size_t count = std::min(static_cast<size_t>(chunkRemaining), input.size());
+    file.read(reinterpret_cast<char*>(input.data()), count);
+    if (static_cast<size_t>(file.gcount()) != count) {
+        inImageData = false;
+        return fail("Truncated IDAT chunk");
+    }
+    chunkCRC = CRC32::update(chunkCRC, input.data(), count);
+    chunkRemaining -= static_cast<uint32_t>(count);
+
+    data = input.data();
+    size = count;
+    return true;
+}
+
+bool PNGRowReader::fail(const std::string& message) {
+    std::cout << "Error: " << message << std::endl;
+    // A chunk the header rejected names the cause better than this message.
+    if (error.empty()) {
+        error = header.getError().empty() ? message : header.getError();
+    }
+    failed = true;
+    return false;
+}
@@ -0,0 +1,99 @@
+#ifndef PNG_ROW_READER_H
+#define PNG_ROW_READER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "PNGStructs.h"
+#include "PNGImage.h"
+#include "PNGFilter.h"
+#include "PixelFormat.h"
+#include "Inflater.h"
+
+/**
+ * @file PNGRowReader.h
+ * @brief Contains the PNGRowReader class for decoding PNG files one row at a time
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Streams the unfiltered scanlines of a PNG file with constant memory
+ *
+ * The file is read sequentially through a small buffer, IDAT payloads are fed
+ * to the Inflater as they arrive and every scanline is unfiltered against the
+ * previous one only. Memory use is two rows plus the 32 KB deflate window and
+ * the input buffer, independent of the image height, so images far larger than
+ * the available RAM can be converted. Rows come out in the layout of
+ * PNGImage::readPNG(), palette images expanded to RGB or RGBA. Interlaced
+ * files are rejected, since no row is complete before the last Adam7 pass.
+ */
+class PNGRowReader {
+public:
+    /**
+     * @brief Default constructor
+     */
+    PNGRowReader();
+
+    /**
+     * @brief Opens a PNG file and reads the chunks up to the first IDAT
+     * @param filename Path to the PNG file
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Closes the file and releases the row buffers
+     */
+    void close();
+
+    /**
+     * @brief Decodes the next scanline
+     * @param row Receives a view of the unfiltered row, valid until the next call
+     * @return true if a row was produced, false at the end of the image or on error
+     */
+    bool nextRow(ByteSpan& row);
+
+    /**
+     * @brief Tells whether every row was decoded without error
+     */
+    bool finished() const { return currentRow == header.height && !failed; }
+
+    /**
+     * @brief Returns a description of the first error since open()
+     */
+    const std::string& getError() const { return error; }
+
+    // Getters
+    uint32_t getWidth() const { return header.width; }
+    uint32_t getHeight() const { return header.height; }
+    uint8_t getChannels() const { return header.channels; }
+    uint8_t getBitDepth() const { return header.bitDepth; }
+    size_t getRowBytes() const { return header.rowBytes(); }
+    uint32_t getCurrentRow() const { return currentRow; }
+
+private:
+    std::ifstream file;
+    PNGImage header;
+    Inflater inflater;
+    PixelFormat::Kernels format;
+
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> current;
+    std::vector<uint8_t> previous;
+    std::vector<uint8_t> unpacked;
+
+    uint32_t chunkRemaining;
+    uint32_t chunkCRC;
+    uint32_t currentRow;
+    bool inImageData;
+    bool failed;
+    std::string error;
+
+    bool readChunkHeader(uint32_t& length, uint32_t& type);
+    bool finishChunk();
+    bool nextInput(const uint8_t*& data, size_t& size);
+    bool fail(const std::string& message);
+};
+
+#endif // PNG_ROW_READER_H
@@ -1,4 +1,5 @@
 #include "PNGStructs.h"
+#include "CRC32.h"
 
 /**
  * @file PNGStructs.cpp
@@ -10,14 +11,14 @@
 // Initialize PNG signature data
 const uint8_t PNGSignature::data[8] = {137, 80, 78, 71, 13, 10, 26, 10};
 
-uint32_t PNGChunk::calculateCRC(const std::vector<uint8_t>& data) {
-    static const uint32_t crcTable[256] = {
-        0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA,
+uint32_t PNGChunk::calculateCRC(uint32_t type, const std::vector<uint8_t>& data) {
+    uint8_t typeBytes[4] = {
+        static_cast<uint8_t>((type >> 24) & 0xFF),
+        static_cast<uint8_t>((type >> 16) & 0xFF),
+        static_cast<uint8_t>((type >> 8) & 0xFF),
+        static_cast<uint8_t>(type & 0xFF)
     };
 
-    uint32_t crc = 0xFFFFFFFF;
-    for (uint8_t byte : data) {
-        crc = crcTable[(crc ^ byte) & 0xFF] ^ (crc >> 8);
-    }
-    return crc ^ 0xFFFFFFFF;
-} 
\ No newline at end of file
+    uint32_t crc = CRC32::update(0, typeBytes, 4);
+    return CRC32::update(crc, data.data(), data.size());
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef PNG_STRUCTS_H
 #define PNG_STRUCTS_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -19,7 +20,9 @@ struct PNGSignature {
 // Chunk types in PNG file
 enum class ChunkType {
     IHDR = 0x49484452,
+    PLTE = 0x504C5445,
     IDAT = 0x49444154,
+    TRNS = 0x74524E53,
     IEND = 0x49454E44
 };
 
@@ -27,9 +30,20 @@ enum class ChunkType {
 enum class ColorType {
     GRAYSCALE = 0,
     RGB = 2,
+    PALETTE = 3,
+    GRAYSCALE_ALPHA = 4,
     RGBA = 6
 };
 
+// Scanline filter types (filter method 0)
+enum class FilterType : uint8_t {
+    NONE = 0,
+    SUB = 1,
+    UP = 2,
+    AVERAGE = 3,
+    PAETH = 4
+};
+
 // Structure representing a PNG chunk
 struct PNGChunk {
     uint32_t length;
@@ -38,11 +52,26 @@ struct PNGChunk {
     uint32_t crc;
 
     /**
-     * @brief Calculates CRC for chunk data
-     * @param data Vector of bytes to calculate CRC for
+     * @brief Calculates the CRC of a chunk, covering its type and data fields
+     * @param type Chunk type code
+     * @param data Vector of chunk data bytes
      * @return Calculated CRC value
      */
-    static uint32_t calculateCRC(const std::vector<uint8_t>& data);
+    static uint32_t calculateCRC(uint32_t type, const std::vector<uint8_t>& data);
+};
+
+// Location of a chunk inside a file that is held in memory
+struct PNGChunkView {
+    uint32_t type;
+    size_t offset;      // offset of the chunk data from the start of the file
+    uint32_t length;
+    uint32_t crc;
+};
+
+// Read-only view of a contiguous range of bytes owned elsewhere
+struct ByteSpan {
+    const uint8_t* data;
+    size_t size;
 };
 
 #endif // PNG_STRUCTS_H 
\ No newline at end of file
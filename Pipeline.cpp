@@ -0,0 +1,77 @@
+#include "Pipeline.h"
+#include "BoundedQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/**
+ * @file Pipeline.cpp
+ * @brief Implementation of Pipeline class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+const size_t Pipeline::DEFAULT_DEPTH;
+
+Pipeline::Pipeline(size_t depth) : depth(std::max<size_t>(depth, 1)) {}
+
+void Pipeline::addStage(size_t threads, const Stage& stage) {
+    StageInfo info = {std::max<size_t>(threads, 1), stage};
+    stages.push_back(info);
+}
+
+bool Pipeline::run(size_t count, const Sink& sink) {
+    // Queue i feeds stage i; the last one feeds the sink. With at most depth
+    // jobs admitted, no queue can ever be full.
+    std::vector<std::unique_ptr<BoundedQueue<size_t> > > queues;
+    for (size_t s = 0; s <= stages.size(); s++) {
+        queues.emplace_back(new BoundedQueue<size_t>(depth));
+    }
+    std::unique_ptr<std::atomic<size_t>[]> claimed(new std::atomic<size_t>[stages.size()]);
+    // A job is owned by one stage at a time and handed on through a queue,
+    // so its flag needs no synchronization of its own.
+    std::vector<uint8_t> failed(count, 0);
+
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < stages.size(); s++) {
+        claimed[s] = 0;
+        for (size_t t = 0; t < stages[s].threads; t++) {
+            threads.emplace_back([&, s]() {
+                // Each claim stands for one job that will arrive on the queue.
+                while (claimed[s].fetch_add(1) < count) {
+                    size_t job = queues[s]->pop();
+                    if (!failed[job] && !stages[s].stage(job)) {
+                        failed[job] = 1;
+                    }
+                    queues[s + 1]->push(job);
+                }
+            });
+        }
+    }
+
+    // Jobs finish out of order when a stage has several threads; they wait
+    // in ready until every job before them has reached the sink.
+    std::vector<uint8_t> ready(count, 0);
+    size_t admitted = 0;
+    size_t done = 0;
+    bool ok = true;
+    while (done < count) {
+        while (admitted < count && admitted - done < depth) {
+            queues[0]->push(admitted++);
+        }
+        ready[queues.back()->pop()] = 1;
+        while (done < count && ready[done]) {
+            if (!sink(done, failed[done] == 0)) {
+                ok = false;
+            }
+            done++;
+        }
+    }
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    return ok;
+}
@@ -0,0 +1,71 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @file Pipeline.h
+ * @brief Contains Pipeline class for overlapping the stages of a batch of jobs
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Runs numbered jobs through a chain of stages with bounded queues in between
+ *
+ * Every stage has its own threads, so a stage waiting on the disk never holds
+ * up one busy with the CPU. Jobs are identified by their index; the stages
+ * keep their state in whatever the caller indexes with it. At most depth
+ * jobs are in flight at once, which bounds the memory held by half-finished
+ * jobs and keeps the queues from ever filling: when the last stage falls
+ * behind, no new jobs are admitted.
+ *
+ * The sink receives every job in index order on the thread calling run(), so
+ * it is the place for work that must happen in order, such as writing files
+ * or reporting results. A job whose stage fails skips the remaining stages
+ * and reaches the sink marked as failed.
+ */
+class Pipeline {
+public:
+    typedef std::function<bool(size_t)> Stage;
+    typedef std::function<bool(size_t, bool)> Sink;
+
+    static const size_t DEFAULT_DEPTH = 16;
+
+    /**
+     * @brief Constructor
+     * @param depth Maximum number of jobs in flight
+     */
+    explicit Pipeline(size_t depth = DEFAULT_DEPTH);
+
+    /**
+     * @brief Appends a stage
+     * @param threads Number of threads running the stage, at least one
+     * @param stage Callback processing one job, returning false if it failed
+     */
+    void addStage(size_t threads, const Stage& stage);
+
+    /**
+     * @brief Pushes jobs 0 to count - 1 through every stage and into the sink
+     * @param count Number of jobs
+     * @param sink Callback receiving each job in order and whether its stages
+     *             succeeded, returning false if the job failed after all
+     * @return true if every job succeeded, false otherwise
+     */
+    bool run(size_t count, const Sink& sink);
+
+    size_t getDepth() const { return depth; }
+
+private:
+    struct StageInfo {
+        size_t threads;
+        Stage stage;
+    };
+
+    size_t depth;
+    std::vector<StageInfo> stages;
+};
+
+#endif // PIPELINE_H
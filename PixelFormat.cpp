@@ -0,0 +1,209 @@
+#include "PixelFormat.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @file PixelFormat.cpp
+ * @brief Implementation of PixelFormat class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+// Expands one row of palette indices of Bits bits each, packed from the most
+// significant bit, into 8-bit pixels of Channels channels (3 or 4). Both are
+// compile-time constants, so the index extraction becomes fixed shifts and
+// masks and the copy a fixed number of byte moves.
+template <unsigned Bits, unsigned Channels>
+void expandPalette(const uint8_t* scanline, uint8_t* out, uint32_t width, const uint8_t* palette) {
+    const unsigned perByte = 8 / Bits;
+    const unsigned mask = (1u << Bits) - 1;
+    for (uint32_t x = 0; x < width; x++) {
+        unsigned shift = 8 - Bits - (x % perByte) * Bits;
+        unsigned index = (scanline[x / perByte] >> shift) & mask;
+        const uint8_t* entry = palette + index * 4;
+        for (unsigned c = 0; c < Channels; c++) {
+            out[c] = entry[c];
+        }
+        out += Channels;
+    }
+}
+
+// Strided copies of whole-byte pixels. With the pixel size and the step known
+// at compile time the inner copy is a fixed-size move and the addressing a
+// constant stride.
+template <unsigned Bytes, unsigned Step>
+void scatterBytes(const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t start) {
+    dst += static_cast<size_t>(start) * Bytes;
+    for (uint32_t i = 0; i < count; i++) {
+        std::memcpy(dst, src, Bytes);
+        src += Bytes;
+        dst += Bytes * Step;
+    }
+}
+
+template <unsigned Bytes, unsigned Step>
+void gatherBytes(const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t start) {
+    src += static_cast<size_t>(start) * Bytes;
+    for (uint32_t i = 0; i < count; i++) {
+        std::memcpy(dst, src, Bytes);
+        src += Bytes * Step;
+        dst += Bytes;
+    }
+}
+
+// Moves one Bits-wide pixel between packed rows, most significant bits first.
+template <unsigned Bits>
+inline void copyPackedPixel(const uint8_t* src, size_t from, uint8_t* dst, size_t to) {
+    const unsigned perByte = 8 / Bits;
+    const unsigned mask = (1u << Bits) - 1;
+    unsigned value = (src[from / perByte] >> (8 - Bits - (from % perByte) * Bits)) & mask;
+    unsigned shift = 8 - Bits - (to % perByte) * Bits;
+    uint8_t& target = dst[to / perByte];
+    target = static_cast<uint8_t>((target & ~(mask << shift)) | (value << shift));
+}
+
+template <unsigned Bits, unsigned Step>
+void scatterBits(const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t start) {
+    for (uint32_t i = 0; i < count; i++) {
+        copyPackedPixel<Bits>(src, i, dst, start + static_cast<size_t>(i) * Step);
+    }
+}
+
+template <unsigned Bits, unsigned Step>
+void gatherBits(const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t start) {
+    for (uint32_t i = 0; i < count; i++) {
+        copyPackedPixel<Bits>(src, start + static_cast<size_t>(i) * Step, dst, i);
+    }
+}
+
+template <unsigned Bytes>
+void selectByteKernels(PixelFormat::Kernels& kernels) {
+    PixelFormat::StridedFunction scatter[] = {
+        scatterBytes<Bytes, 1>, scatterBytes<Bytes, 2>, scatterBytes<Bytes, 4>, scatterBytes<Bytes, 8>
+    };
+    PixelFormat::StridedFunction gather[] = {
+        gatherBytes<Bytes, 1>, gatherBytes<Bytes, 2>, gatherBytes<Bytes, 4>, gatherBytes<Bytes, 8>
+    };
+    std::copy(scatter, scatter + PixelFormat::STEP_COUNT, kernels.scatter);
+    std::copy(gather, gather + PixelFormat::STEP_COUNT, kernels.gather);
+}
+
+template <unsigned Bits>
+void selectBitKernels(PixelFormat::Kernels& kernels) {
+    PixelFormat::StridedFunction scatter[] = {
+        scatterBits<Bits, 1>, scatterBits<Bits, 2>, scatterBits<Bits, 4>, scatterBits<Bits, 8>
+    };
+    PixelFormat::StridedFunction gather[] = {
+        gatherBits<Bits, 1>, gatherBits<Bits, 2>, gatherBits<Bits, 4>, gatherBits<Bits, 8>
+    };
+    std::copy(scatter, scatter + PixelFormat::STEP_COUNT, kernels.scatter);
+    std::copy(gather, gather + PixelFormat::STEP_COUNT, kernels.gather);
+}
+
+// One row of the dispatch table.
+struct FormatEntry {
+    ColorType colorType;
+    uint8_t bitDepth;
+    uint8_t samples;
+    PixelFormat::UnpackFunction unpackOpaque;       // palette to RGB
+    PixelFormat::UnpackFunction unpackTranslucent;  // palette to RGBA
+};
+
+// Every combination the PNG specification allows, and nothing else.
+const FormatEntry FORMATS[] = {
+    {ColorType::GRAYSCALE, 1, 1, nullptr, nullptr},
+    {ColorType::GRAYSCALE, 2, 1, nullptr, nullptr},
+    {ColorType::GRAYSCALE, 4, 1, nullptr, nullptr},
+    {ColorType::GRAYSCALE, 8, 1, nullptr, nullptr},
+    {ColorType::GRAYSCALE, 16, 1, nullptr, nullptr},
+    {ColorType::RGB, 8, 3, nullptr, nullptr},
+    {ColorType::RGB, 16, 3, nullptr, nullptr},
+    {ColorType::PALETTE, 1, 1, expandPalette<1, 3>, expandPalette<1, 4>},
+    {ColorType::PALETTE, 2, 1, expandPalette<2, 3>, expandPalette<2, 4>},
+    {ColorType::PALETTE, 4, 1, expandPalette<4, 3>, expandPalette<4, 4>},
+    {ColorType::PALETTE, 8, 1, expandPalette<8, 3>, expandPalette<8, 4>},
+    {ColorType::GRAYSCALE_ALPHA, 8, 2, nullptr, nullptr},
+    {ColorType::GRAYSCALE_ALPHA, 16, 2, nullptr, nullptr},
+    {ColorType::RGBA, 8, 4, nullptr, nullptr},
+    {ColorType::RGBA, 16, 4, nullptr, nullptr}
+};
+
+const FormatEntry* findFormat(uint8_t colorType, uint8_t bitDepth) {
+    for (size_t i = 0; i < sizeof(FORMATS) / sizeof(FORMATS[0]); i++) {
+        if (static_cast<uint8_t>(FORMATS[i].colorType) == colorType && FORMATS[i].bitDepth == bitDepth) {
+            return &FORMATS[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+const size_t PixelFormat::PALETTE_SIZE;
+const size_t PixelFormat::STEP_COUNT;
+
+bool PixelFormat::isValid(uint8_t colorType, uint8_t bitDepth) {
+    return findFormat(colorType, bitDepth) != nullptr;
+}
+
+bool PixelFormat::select(uint8_t colorType, uint8_t bitDepth, bool transparentPalette, Kernels& kernels) {
+    const FormatEntry* entry = findFormat(colorType, bitDepth);
+    if (!entry) {
+        return false;
+    }
+
+    kernels.colorType = entry->colorType;
+    kernels.bitDepth = entry->bitDepth;
+    kernels.samples = entry->samples;
+    if (entry->colorType == ColorType::PALETTE) {
+        kernels.decodedType = transparentPalette ? ColorType::RGBA : ColorType::RGB;
+        kernels.decodedChannels = transparentPalette ? 4 : 3;
+        kernels.decodedBitDepth = 8;
+        kernels.unpack = transparentPalette ? entry->unpackTranslucent : entry->unpackOpaque;
+    } else {
+        kernels.decodedType = entry->colorType;
+        kernels.decodedChannels = entry->samples;
+        kernels.decodedBitDepth = entry->bitDepth;
+        kernels.unpack = nullptr;
+    }
+
+    // Filters work on whole bytes; sub-byte pixels count as one.
+    size_t bits = static_cast<size_t>(entry->samples) * entry->bitDepth;
+    kernels.filterBytes = bits >= 8 ? bits / 8 : 1;
+    kernels.unfilter = PNGFilter::selectUnfilterKernels(kernels.filterBytes);
+
+    switch (kernels.decodedChannels * kernels.decodedBitDepth) {
+        case 1: selectBitKernels<1>(kernels); break;
+        case 2: selectBitKernels<2>(kernels); break;
+        case 4: selectBitKernels<4>(kernels); break;
+        case 8: selectByteKernels<1>(kernels); break;
+        case 16: selectByteKernels<2>(kernels); break;
+        case 24: selectByteKernels<3>(kernels); break;
+        case 32: selectByteKernels<4>(kernels); break;
+        case 48: selectByteKernels<6>(kernels); break;
+        default: selectByteKernels<8>(kernels); break;
+    }
+    return true;
+}
+
+bool PixelFormat::colorTypeFor(uint8_t channels, uint8_t bitDepth, ColorType& colorType) {
+    switch (channels) {
+        case 1: colorType = ColorType::GRAYSCALE; break;
+        case 2: colorType = ColorType::GRAYSCALE_ALPHA; break;
+        case 3: colorType = ColorType::RGB; break;
+        case 4: colorType = ColorType::RGBA; break;
+        default: return false;
+    }
+    return isValid(static_cast<uint8_t>(colorType), bitDepth);
+}
+
+uint8_t PixelFormat::samplesPerPixel(uint8_t colorType) {
+    for (size_t i = 0; i < sizeof(FORMATS) / sizeof(FORMATS[0]); i++) {
+        if (static_cast<uint8_t>(FORMATS[i].colorType) == colorType) {
+            return FORMATS[i].samples;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include "PNGStructs.h"
+#include "PNGFilter.h"
+
+/**
+ * @file PixelFormat.h
+ * @brief Contains PixelFormat class, the per-format kernels of the PNG pixel pipeline
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * Every valid combination of PNG color type and bit depth has one entry in a
+ * dispatch table. The entry is looked up once per image and tells how wide a
+ * scanline is, which unfilter kernels apply and how the unfiltered scanline
+ * becomes decoded pixels:
+ *
+ *   grayscale 1/2/4/8/16, gray+alpha 8/16, RGB 8/16, RGBA 8/16
+ *       the scanline already is the pixel row: sub-byte samples stay packed
+ *       and 16-bit samples stay big-endian, exactly as in the file
+ *   palette 1/2/4/8
+ *       indices are expanded to 8-bit RGB, or RGBA when tRNS gives any
+ *       entry an alpha below 255, by a kernel instantiated for the index size
+ *
+ * Decoded pixels are therefore described by channels and bit depth alone
+ * (1 gray, 2 gray+alpha, 3 RGB, 4 RGBA), which is what .samet stores and
+ * what the encoder writes back.
+ *
+ * Interlaced images additionally need strided copies between the reduced
+ * Adam7 images and the full one. Those kernels are instantiated for every
+ * decoded pixel size and for the steps 1, 2, 4 and 8 that Adam7 uses.
+ */
+
+class PixelFormat {
+public:
+    /**
+     * @brief Signature of a kernel that turns one unfiltered scanline into pixels
+     * @param scanline Unfiltered scanline without its filter type byte
+     * @param out Destination row of decoded pixels
+     * @param width Pixels in the row
+     * @param palette 256 RGBA entries, for palette images only
+     */
+    typedef void (*UnpackFunction)(const uint8_t* scanline, uint8_t* out, uint32_t width,
+                                   const uint8_t* palette);
+
+    /**
+     * @brief Signature of a kernel that copies every step-th pixel of a row
+     *
+     * A scatter kernel spreads count dense pixels of src over dst starting at
+     * pixel start; a gather kernel collects count pixels of src starting at
+     * pixel start into dense dst. Sub-byte pixels outside the copied ones are
+     * left untouched.
+     * @param src Source row
+     * @param dst Destination row
+     * @param count Pixels to copy
+     * @param start Index of the first pixel in the strided row
+     */
+    typedef void (*StridedFunction)(const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t start);
+
+    /**
+     * @brief Number of strided kernel variants, for the steps 1, 2, 4 and 8
+     */
+    static const size_t STEP_COUNT = 4;
+
+    /**
+     * @brief Kernels and geometry of one pixel format, chosen once per image
+     */
+    struct Kernels {
+        ColorType colorType;                // color type in the file
+        uint8_t bitDepth;                   // bits per sample in the file
+        uint8_t samples;                    // samples per pixel in the file
+        ColorType decodedType;              // color type of the decoded pixels
+        uint8_t decodedChannels;
+        uint8_t decodedBitDepth;
+        size_t filterBytes;                 // filter pixel size, at least 1
+        PNGFilter::UnfilterKernels unfilter;
+        UnpackFunction unpack;              // null when the scanline is the pixel row
+        StridedFunction scatter[STEP_COUNT];  // indexed by log2 of the step
+        StridedFunction gather[STEP_COUNT];
+
+        /**
+         * @brief Bytes of one scanline in the file, without the filter type byte
+         */
+        size_t scanlineBytes(uint32_t width) const {
+            return (static_cast<size_t>(width) * samples * bitDepth + 7) / 8;
+        }
+
+        /**
+         * @brief Bytes of one row of decoded pixels
+         */
+        size_t decodedRowBytes(uint32_t width) const {
+            return (static_cast<size_t>(width) * decodedChannels * decodedBitDepth + 7) / 8;
+        }
+    };
+
+    /**
+     * @brief Number of palette entries a PLTE chunk can hold
+     */
+    static const size_t PALETTE_SIZE = 256;
+
+    /**
+     * @brief Tells whether the PNG specification allows a color type and bit depth
+     */
+    static bool isValid(uint8_t colorType, uint8_t bitDepth);
+
+    /**
+     * @brief Looks up the kernels of a file format
+     * @param colorType Color type from IHDR
+     * @param bitDepth Bit depth from IHDR
+     * @param transparentPalette Whether tRNS makes any palette entry translucent
+     * @param kernels Receives the kernels
+     * @return true if successful, false for a combination the specification forbids
+     */
+    static bool select(uint8_t colorType, uint8_t bitDepth, bool transparentPalette, Kernels& kernels);
+
+    /**
+     * @brief Finds the color type that stores decoded pixels without conversion
+     * @param channels 1 gray, 2 gray+alpha, 3 RGB or 4 RGBA
+     * @param bitDepth Bits per sample
+     * @param colorType Receives the color type
+     * @return true if successful, false if PNG cannot store the pixels as they are
+     */
+    static bool colorTypeFor(uint8_t channels, uint8_t bitDepth, ColorType& colorType);
+
+    /**
+     * @brief Number of samples per pixel of a color type, 0 for an unknown one
+     */
+    static uint8_t samplesPerPixel(uint8_t colorType);
+};
+
+#endif // PIXEL_FORMAT_H
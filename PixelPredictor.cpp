@@ -0,0 +1,410 @@
+#include "PixelPredictor.h"
+#include "PNGFilter.h"
+#include "CPUFeatures.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * @file PixelPredictor.cpp
+ * @brief Implementation of PixelPredictor class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+// Signature of a kernel writing the residuals of one row
+typedef void (*ResidualFunction)(uint8_t* out, const uint8_t* row, const uint8_t* prior,
+                                 size_t length, size_t bytesPerPixel);
+
+// Signature of a color transform of one row; in and out may be the same row
+typedef void (*ColorFunction)(const uint8_t* in, uint8_t* out, size_t length);
+
+inline uint8_t halfSigned(uint8_t v) {
+    return static_cast<uint8_t>(static_cast<int8_t>(v) >> 1);
+}
+
+inline uint8_t medPredictor(int a, int b, int c) {
+    int low = std::min(a, b);
+    int high = std::max(a, b);
+    if (c >= high) return static_cast<uint8_t>(low);
+    if (c <= low) return static_cast<uint8_t>(high);
+    return static_cast<uint8_t>(a + b - c);
+}
+
+template <size_t CHANNELS>
+void forwardScalar(const uint8_t* in, uint8_t* out, size_t length) {
+    for (size_t i = 0; i + CHANNELS <= length; i += CHANNELS) {
+        uint8_t co = static_cast<uint8_t>(in[i] - in[i + 2]);
+        uint8_t t = static_cast<uint8_t>(in[i + 2] + halfSigned(co));
+        uint8_t cg = static_cast<uint8_t>(in[i + 1] - t);
+        out[i] = static_cast<uint8_t>(t + halfSigned(cg));
+        out[i + 1] = co;
+        out[i + 2] = cg;
+        if (CHANNELS == 4) out[i + 3] = in[i + 3];
+    }
+}
+
+template <size_t CHANNELS>
+void inverseScalar(const uint8_t* in, uint8_t* out, size_t length) {
+    for (size_t i = 0; i + CHANNELS <= length; i += CHANNELS) {
+        uint8_t co = in[i + 1];
+        uint8_t cg = in[i + 2];
+        uint8_t t = static_cast<uint8_t>(in[i] - halfSigned(cg));
+        uint8_t b = static_cast<uint8_t>(t - halfSigned(co));
+        out[i + 1] = static_cast<uint8_t>(cg + t);
+        out[i + 2] = b;
+        out[i] = static_cast<uint8_t>(b + co);
+        if (CHANNELS == 4) out[i + 3] = in[i + 3];
+    }
+}
+
+void medResidualScalar(uint8_t* out, const uint8_t* row, const uint8_t* prior,
+                       size_t length, size_t bytesPerPixel) {
+    size_t bpp = std::min(bytesPerPixel, length);
+    for (size_t i = 0; i < bpp; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+    }
+    for (size_t i = bpp; i < length; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - medPredictor(row[i - bpp], prior[i], prior[i - bpp]));
+    }
+}
+
+// The first pixel of a row has a = c = 0, for which MED predicts b.
+template <size_t BPP>
+void medScalar(uint8_t* row, const uint8_t* prior, size_t length) {
+    for (size_t i = 0; i < BPP && i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + prior[i]);
+    }
+    for (size_t i = BPP; i < length; i++) {
+        row[i] = static_cast<uint8_t>(row[i] + medPredictor(row[i - BPP], prior[i], prior[i - BPP]));
+    }
+}
+
+#ifdef CPU_X86_SIMD
+
+TARGET_SSE2 inline __m128i selectSSE2(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+TARGET_AVX2 inline __m256i selectAVX2(__m256i mask, __m256i a, __m256i b) {
+    return _mm256_blendv_epi8(b, a, mask);
+}
+
+// MED on unsigned bytes: min(a, b) if c >= max(a, b), max(a, b) if
+// c <= min(a, b), else a + b - c, which then lies between the two and
+// cannot wrap. All three cases are computed and blended.
+TARGET_SSE2 inline __m128i medSSE2Vector(__m128i a, __m128i b, __m128i c) {
+    __m128i low = _mm_min_epu8(a, b);
+    __m128i high = _mm_max_epu8(a, b);
+    __m128i gradient = _mm_sub_epi8(_mm_add_epi8(a, b), c);
+    __m128i above = _mm_cmpeq_epi8(_mm_max_epu8(c, high), c);
+    __m128i below = _mm_cmpeq_epi8(_mm_min_epu8(c, low), c);
+    return selectSSE2(above, low, selectSSE2(below, high, gradient));
+}
+
+TARGET_AVX2 inline __m256i medAVX2Vector(__m256i a, __m256i b, __m256i c) {
+    __m256i low = _mm256_min_epu8(a, b);
+    __m256i high = _mm256_max_epu8(a, b);
+    __m256i gradient = _mm256_sub_epi8(_mm256_add_epi8(a, b), c);
+    __m256i above = _mm256_cmpeq_epi8(_mm256_max_epu8(c, high), c);
+    __m256i below = _mm256_cmpeq_epi8(_mm256_min_epu8(c, low), c);
+    return selectAVX2(above, low, selectAVX2(below, high, gradient));
+}
+
+// On the encoder side all neighbours are original pixels, so whole vectors
+// of residuals are computed at once.
+TARGET_SSE2
+void medResidualSSE2(uint8_t* out, const uint8_t* row, const uint8_t* prior,
+                     size_t length, size_t bytesPerPixel) {
+    if (length <= bytesPerPixel) {
+        medResidualScalar(out, row, prior, length, bytesPerPixel);
+        return;
+    }
+    for (size_t i = 0; i < bytesPerPixel; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+    }
+    size_t i = bytesPerPixel;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i - bytesPerPixel));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i - bytesPerPixel));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi8(x, medSSE2Vector(a, b, c)));
+    }
+    for (; i < length; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - medPredictor(row[i - bytesPerPixel], prior[i],
+                                                            prior[i - bytesPerPixel]));
+    }
+}
+
+TARGET_AVX2
+void medResidualAVX2(uint8_t* out, const uint8_t* row, const uint8_t* prior,
+                     size_t length, size_t bytesPerPixel) {
+    if (length <= bytesPerPixel) {
+        medResidualScalar(out, row, prior, length, bytesPerPixel);
+        return;
+    }
+    for (size_t i = 0; i < bytesPerPixel; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - prior[i]);
+    }
+    size_t i = bytesPerPixel;
+    for (; i + 32 <= length; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i - bytesPerPixel));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prior + i));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prior + i - bytesPerPixel));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi8(x, medAVX2Vector(a, b, c)));
+    }
+    for (; i < length; i++) {
+        out[i] = static_cast<uint8_t>(row[i] - medPredictor(row[i - bytesPerPixel], prior[i],
+                                                            prior[i - bytesPerPixel]));
+    }
+}
+
+// Reconstruction depends on the previous pixel, so it steps one pixel at a
+// time with all channels in one vector, as the Paeth kernel of PNGFilter.
+// The wide load reads 8 bytes while 8 remain; only BPP bytes are stored.
+template <size_t BPP>
+TARGET_SSE2 inline __m128i loadPixel(const uint8_t* p) {
+    uint64_t v = 0;
+    std::memcpy(&v, p, BPP);
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&v));
+}
+
+TARGET_SSE2 inline __m128i loadPixelWide(const uint8_t* p) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+}
+
+template <size_t BPP>
+TARGET_SSE2 inline void storePixel(uint8_t* p, __m128i x) {
+    uint64_t v;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&v), x);
+    std::memcpy(p, &v, BPP);
+}
+
+template <size_t BPP>
+TARGET_SSE2
+void medSSE2(uint8_t* row, const uint8_t* prior, size_t length) {
+    __m128i a = _mm_setzero_si128();
+    __m128i c = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= length; i += BPP) {
+        __m128i b = loadPixelWide(prior + i);
+        a = _mm_add_epi8(loadPixelWide(row + i), medSSE2Vector(a, b, c));
+        storePixel<BPP>(row + i, a);
+        c = b;
+    }
+    for (; i + BPP <= length; i += BPP) {
+        __m128i b = loadPixel<BPP>(prior + i);
+        a = _mm_add_epi8(loadPixel<BPP>(row + i), medSSE2Vector(a, b, c));
+        storePixel<BPP>(row + i, a);
+        c = b;
+    }
+}
+
+// YCoCg-R of four RGBA pixels at once. Every step works on the low byte of
+// the 32-bit lanes; halves are taken with an arithmetic shift of that byte
+// moved to the top of a 16-bit lane.
+TARGET_SSE2 inline __m128i halfSignedSSE2(__m128i v) {
+    return _mm_srai_epi16(_mm_slli_epi16(v, 8), 9);
+}
+
+TARGET_SSE2 inline __m128i packYCoCg(__m128i first, __m128i second, __m128i third, __m128i x) {
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    return _mm_or_si128(_mm_or_si128(_mm_and_si128(first, lowByte),
+                                     _mm_slli_epi32(_mm_and_si128(second, lowByte), 8)),
+                        _mm_or_si128(_mm_slli_epi32(_mm_and_si128(third, lowByte), 16),
+                                     _mm_and_si128(x, alpha)));
+}
+
+TARGET_SSE2
+void forwardRGBASSE2(const uint8_t* in, uint8_t* out, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i g = _mm_srli_epi32(x, 8);
+        __m128i b = _mm_srli_epi32(x, 16);
+        __m128i co = _mm_sub_epi8(x, b);
+        __m128i t = _mm_add_epi8(b, halfSignedSSE2(co));
+        __m128i cg = _mm_sub_epi8(g, t);
+        __m128i y = _mm_add_epi8(t, halfSignedSSE2(cg));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packYCoCg(y, co, cg, x));
+    }
+    forwardScalar<4>(in + i, out + i, length - i);
+}
+
+TARGET_SSE2
+void inverseRGBASSE2(const uint8_t* in, uint8_t* out, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i co = _mm_srli_epi32(x, 8);
+        __m128i cg = _mm_srli_epi32(x, 16);
+        __m128i t = _mm_sub_epi8(x, halfSignedSSE2(cg));
+        __m128i g = _mm_add_epi8(cg, t);
+        __m128i b = _mm_sub_epi8(t, halfSignedSSE2(co));
+        __m128i r = _mm_add_epi8(b, co);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packYCoCg(r, g, b, x));
+    }
+    inverseScalar<4>(in + i, out + i, length - i);
+}
+
+#endif // CPU_X86_SIMD
+
+ResidualFunction selectMEDResidual() {
+#ifdef CPU_X86_SIMD
+    const CPUFeatures& cpu = CPUFeatures::get();
+    if (cpu.avx2) return medResidualAVX2;
+    if (cpu.sse2) return medResidualSSE2;
+#endif
+    return medResidualScalar;
+}
+
+template <size_t BPP>
+PNGFilter::UnfilterFunction medFor() {
+#ifdef CPU_X86_SIMD
+    // One- and two-byte pixels gain nothing from per-pixel vectors.
+    if (BPP >= 3 && CPUFeatures::get().sse2) {
+        return medSSE2<BPP>;
+    }
+#endif
+    return medScalar<BPP>;
+}
+
+PNGFilter::UnfilterFunction selectMED(size_t bytesPerPixel) {
+    switch (bytesPerPixel) {
+        case 1: return medFor<1>();
+        case 2: return medFor<2>();
+        case 3: return medFor<3>();
+        case 4: return medFor<4>();
+        case 6: return medFor<6>();
+        default: return medFor<8>();
+    }
+}
+
+ColorFunction selectForward(size_t channels) {
+#ifdef CPU_X86_SIMD
+    if (channels == 4 && CPUFeatures::get().sse2) return forwardRGBASSE2;
+#endif
+    return channels == 4 ? forwardScalar<4> : forwardScalar<3>;
+}
+
+ColorFunction selectInverse(size_t channels) {
+#ifdef CPU_X86_SIMD
+    if (channels == 4 && CPUFeatures::get().sse2) return inverseRGBASSE2;
+#endif
+    return channels == 4 ? inverseScalar<4> : inverseScalar<3>;
+}
+
+} // namespace
+
+void PixelPredictor::predict(SametPredictor predictor, SametColorTransform color, const uint8_t* pixels,
+                             size_t stride, size_t rowLength, size_t rows, size_t bytesPerPixel,
+                             uint8_t* residuals) {
+    // Scratch: a row of zeros above the block, then two rows of transformed
+    // pixels used alternately as current and prior row.
+    bool transform = color == SametColorTransform::YCOCG_R;
+    thread_local std::vector<uint8_t> scratch;
+    scratch.assign(rowLength * (transform ? 3 : 1), 0);
+    ColorFunction forward = transform ? selectForward(bytesPerPixel) : nullptr;
+    ResidualFunction med = predictor == SametPredictor::MED ? selectMEDResidual() : nullptr;
+
+    const uint8_t* prior = scratch.data();
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* row = pixels + r * stride;
+        if (transform) {
+            uint8_t* transformed = scratch.data() + rowLength * (1 + (r & 1));
+            forward(row, transformed, rowLength);
+            row = transformed;
+        }
+        uint8_t* out = residuals + r * rowLength;
+        switch (predictor) {
+            case SametPredictor::NONE:
+                std::memcpy(out, row, rowLength);
+                break;
+            case SametPredictor::LEFT:
+                PNGFilter::filterRow(FilterType::SUB, out, row, prior, rowLength, bytesPerPixel);
+                break;
+            case SametPredictor::UP:
+                PNGFilter::filterRow(FilterType::UP, out, row, prior, rowLength, bytesPerPixel);
+                break;
+            case SametPredictor::AVERAGE:
+                PNGFilter::filterRow(FilterType::AVERAGE, out, row, prior, rowLength, bytesPerPixel);
+                break;
+            case SametPredictor::MED:
+                med(out, row, prior, rowLength, bytesPerPixel);
+                break;
+        }
+        prior = row;
+    }
+}
+
+bool PixelPredictor::reconstruct(SametPredictor predictor, SametColorTransform color, uint8_t* residuals,
+                                 size_t rowLength, size_t rows, size_t bytesPerPixel,
+                                 uint8_t* out, size_t outStride) {
+    if (!supportsPixelSize(bytesPerPixel)) {
+        return false;
+    }
+
+    // Left, up and average are the PNG Sub, Up and Average filters.
+    PNGFilter::UnfilterFunction kernel = nullptr;
+    switch (predictor) {
+        case SametPredictor::NONE: break;
+        case SametPredictor::LEFT: kernel = PNGFilter::selectUnfilterKernels(bytesPerPixel).sub; break;
+        case SametPredictor::UP: kernel = PNGFilter::selectUnfilterKernels(bytesPerPixel).up; break;
+        case SametPredictor::AVERAGE: kernel = PNGFilter::selectUnfilterKernels(bytesPerPixel).average; break;
+        case SametPredictor::MED: kernel = selectMED(bytesPerPixel); break;
+        default: return false;
+    }
+
+    ColorFunction inverse = nullptr;
+    switch (color) {
+        case SametColorTransform::NONE:
+            break;
+        case SametColorTransform::YCOCG_R:
+            if (bytesPerPixel != 3 && bytesPerPixel != 4) {
+                return false;
+            }
+            inverse = selectInverse(bytesPerPixel);
+            break;
+        default:
+            return false;
+    }
+
+    // A row is emitted once the next one no longer needs it as its prior
+    // row, which lets the inverse transform run in place.
+    auto emit = [&](size_t r) {
+        const uint8_t* row = residuals + r * rowLength;
+        uint8_t* target = out + r * outStride;
+        if (inverse) {
+            inverse(row, target, rowLength);
+        } else if (target != row) {
+            std::memcpy(target, row, rowLength);
+        }
+    };
+
+    thread_local std::vector<uint8_t> zeros;
+    zeros.assign(rowLength, 0);
+    const uint8_t* prior = zeros.data();
+    for (size_t r = 0; r < rows; r++) {
+        uint8_t* row = residuals + r * rowLength;
+        if (kernel) {
+            kernel(row, prior, rowLength);
+        }
+        if (r > 0) {
+            emit(r - 1);
+        }
+        prior = row;
+    }
+    if (rows > 0) {
+        emit(rows - 1);
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef PIXEL_PREDICTOR_H
+#define PIXEL_PREDICTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SametFormat.h"
+
+/**
+ * @file PixelPredictor.h
+ * @brief Contains PixelPredictor class, the reversible pixel preprocessing of .samet blocks
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * A block of rows is first color transformed, for 8-bit RGB and RGBA pixels,
+ * with the lifting form of YCoCg-R computed modulo 256:
+ *
+ *   Co = R - B     t = B + (Co >> 1)     Cg = G - t     Y = t + (Cg >> 1)
+ *
+ * where the shifts treat Co and Cg as signed bytes; alpha is left alone.
+ * Every byte is then replaced by its difference from a prediction made
+ * from the byte one pixel to the left (a), the one above (b) and the one
+ * above-left (c), all within the block:
+ *
+ *   LEFT a     UP b     AVERAGE (a + b) / 2     MED median(a, b, a + b - c)
+ *
+ * Blocks are predicted independently: the first row sees zeros above and
+ * the first pixel of a row zeros to its left, as in PNG.
+ */
+
+/**
+ * @brief Color transform and spatial prediction of blocks of pixel rows
+ *
+ * Stateless; the SIMD kernels are picked per block from CPUFeatures.
+ */
+class PixelPredictor {
+public:
+    /**
+     * @brief Tells whether the YCoCg-R transform applies to a pixel format
+     */
+    static bool supportsColorTransform(uint8_t channels, uint8_t bitDepth) {
+        return bitDepth == 8 && (channels == 3 || channels == 4);
+    }
+
+    /**
+     * @brief Tells whether a pixel size can be predicted; smaller pixels count as 1 byte
+     */
+    static bool supportsPixelSize(size_t bytesPerPixel) {
+        return bytesPerPixel == 1 || bytesPerPixel == 2 || bytesPerPixel == 3 ||
+               bytesPerPixel == 4 || bytesPerPixel == 6 || bytesPerPixel == 8;
+    }
+
+    /**
+     * @brief Transforms and predicts a block of rows into contiguous residuals
+     * @param predictor Spatial predictor
+     * @param color Color transform, YCOCG_R only for supportsColorTransform() formats
+     * @param pixels First row
+     * @param stride Distance between rows
+     * @param rowLength Bytes per row
+     * @param rows Number of rows
+     * @param bytesPerPixel Distance to the corresponding byte of the left pixel
+     * @param residuals Output of rowLength * rows bytes
+     */
+    static void predict(SametPredictor predictor, SametColorTransform color, const uint8_t* pixels,
+                        size_t stride, size_t rowLength, size_t rows, size_t bytesPerPixel,
+                        uint8_t* residuals);
+
+    /**
+     * @brief Rebuilds the pixels of a block from its residuals
+     *
+     * Reconstruction and color inversion run in one pass: the inverse color
+     * transform of a row is written to the output right after the row below
+     * it has been reconstructed. The residuals are overwritten; out may be
+     * the residual buffer itself when outStride equals rowLength.
+     * @param predictor Spatial predictor the block was coded with
+     * @param color Color transform the block was coded with
+     * @param residuals Contiguous residual rows
+     * @param rowLength Bytes per row
+     * @param rows Number of rows
+     * @param bytesPerPixel Distance to the corresponding byte of the left pixel
+     * @param out First output row
+     * @param outStride Distance between output rows
+     * @return true if successful, false for an unknown predictor or transform or
+     *         a pixel size supportsPixelSize() rejects
+     */
+    static bool reconstruct(SametPredictor predictor, SametColorTransform color, uint8_t* residuals,
+                            size_t rowLength, size_t rows, size_t bytesPerPixel,
+                            uint8_t* out, size_t outStride);
+};
+
+#endif // PIXEL_PREDICTOR_H
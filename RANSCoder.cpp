@@ -0,0 +1,245 @@
+#include "RANSCoder.h"
+#include <cstring>
+
+/**
+ * @file RANSCoder.cpp
+ * @brief Implementation of the RANSCoder class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+const uint32_t PROB_SCALE = 1u << RANSCoder::PROB_BITS;
+const uint32_t PROB_MASK = PROB_SCALE - 1;
+const uint32_t STATE_LOW = 1u << 16;    // states stay in [STATE_LOW, 2^32)
+const unsigned WAYS = 4;
+
+// Decoder lookup for one frequency slot: frequency minus one in bits 0-11,
+// slot minus the symbol's cumulative frequency in bits 12-23 and the symbol
+// in bits 24-31.
+inline uint32_t slotEntry(uint32_t freq, uint32_t bias, uint32_t symbol) {
+    return (freq - 1) | (bias << 12) | (symbol << 24);
+}
+
+// Advances a state past the symbol in its low bits and returns the symbol.
+inline uint8_t decodeSymbol(const uint32_t* table, uint32_t& state) {
+    uint32_t slot = table[state & PROB_MASK];
+    state = ((slot & PROB_MASK) + 1) * (state >> RANSCoder::PROB_BITS) + ((slot >> 12) & PROB_MASK);
+    return static_cast<uint8_t>(slot >> 24);
+}
+
+inline uint32_t readLE16(const uint8_t* in);
+
+// Pulls a word into a state that fell below STATE_LOW; the word is read
+// either way, so at least two bytes must remain.
+inline void renormalize(uint32_t& state, const uint8_t*& wp) {
+    uint32_t refill = state < STATE_LOW;
+    uint32_t word = readLE16(wp);
+    // Shift-and-mask rather than a conditional, which compilers turn into
+    // a badly predicted branch.
+    state = (state << (refill << 4)) | (word & (0u - refill));
+    wp += refill * 2;
+}
+
+inline void writeLE16(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline uint32_t readLE16(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8);
+}
+
+inline uint32_t readLE32(const uint8_t* in) {
+    return readLE16(in) | (readLE16(in + 2) << 16);
+}
+
+// Scales byte counts to frequencies summing to PROB_SCALE, keeping every
+// byte that occurs at a frequency of at least 1.
+void normalize(const uint32_t* counts, size_t total, uint32_t* freq) {
+    uint32_t sum = 0;
+    unsigned largest = 0;
+    for (unsigned s = 0; s < 256; s++) {
+        freq[s] = 0;
+        if (counts[s] != 0) {
+            uint64_t scaled = static_cast<uint64_t>(counts[s]) * PROB_SCALE / total;
+            freq[s] = scaled != 0 ? static_cast<uint32_t>(scaled) : 1;
+            sum += freq[s];
+            if (freq[s] > freq[largest]) {
+                largest = s;
+            }
+        }
+    }
+    if (sum < PROB_SCALE) {
+        freq[largest] += PROB_SCALE - sum;
+    }
+    // A byte alone would get the whole range and cost nothing; hand one slot
+    // to an unused value so that every symbol costs some bits.
+    if (freq[largest] == PROB_SCALE) {
+        freq[largest]--;
+        freq[(largest + 1) & 255] = 1;
+        return;
+    }
+    // Rounding up rare bytes can overshoot; take it back from the most
+    // frequent ones, where it costs the least.
+    while (sum > PROB_SCALE) {
+        unsigned top = 0;
+        for (unsigned s = 1; s < 256; s++) {
+            if (freq[s] > freq[top]) {
+                top = s;
+            }
+        }
+        freq[top]--;
+        sum--;
+    }
+}
+
+} // namespace
+
+const unsigned RANSCoder::PROB_BITS;
+
+size_t RANSCoder::encode(const uint8_t* data, size_t size, uint8_t* out) {
+    uint32_t counts[256] = {0};
+    for (size_t i = 0; i < size; i++) {
+        counts[data[i]]++;
+    }
+    uint32_t freq[256] = {0};
+    if (size != 0) {
+        normalize(counts, size, freq);
+    }
+
+    uint8_t* op = out + 2;
+    uint32_t cumulative[256];
+    uint32_t symbolCount = 0;
+    uint32_t cum = 0;
+    for (unsigned s = 0; s < 256; s++) {
+        cumulative[s] = cum;
+        cum += freq[s];
+        if (freq[s] != 0) {
+            op[0] = static_cast<uint8_t>(s);
+            writeLE16(op + 1, freq[s]);
+            op += 3;
+            symbolCount++;
+        }
+    }
+    writeLE16(out, symbolCount);
+
+    // The input is coded back to front so that it decodes front to back;
+    // the words are written downwards from the end of the buffer and moved
+    // into place afterwards.
+    uint8_t* wordsEnd = out + maxEncodedSize(size);
+    uint8_t* wp = wordsEnd;
+    uint32_t state[WAYS] = {STATE_LOW, STATE_LOW, STATE_LOW, STATE_LOW};
+    for (size_t i = size; i-- > 0;) {
+        uint32_t& x = state[i & (WAYS - 1)];
+        uint32_t f = freq[data[i]];
+        uint64_t limit = static_cast<uint64_t>((STATE_LOW >> PROB_BITS) << 16) * f;
+        if (x >= limit) {
+            wp -= 2;
+            writeLE16(wp, x);
+            x >>= 16;
+        }
+        x = ((x / f) << PROB_BITS) + (x % f) + cumulative[data[i]];
+    }
+
+    for (unsigned k = 0; k < WAYS; k++) {
+        writeLE16(op, state[k]);
+        writeLE16(op + 2, state[k] >> 16);
+        op += 4;
+    }
+    size_t wordBytes = static_cast<size_t>(wordsEnd - wp);
+    std::memmove(op, wp, wordBytes);
+    op += wordBytes;
+    return static_cast<size_t>(op - out);
+}
+
+bool RANSCoder::decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    if (srcSize < 2) {
+        return false;
+    }
+    uint32_t symbolCount = readLE16(src);
+    if (symbolCount > 256 || srcSize < 2 + symbolCount * 3 + WAYS * 4) {
+        return false;
+    }
+    if (symbolCount == 0) {
+        return dstSize == 0 && srcSize == 2 + WAYS * 4;
+    }
+
+    uint32_t table[PROB_SCALE];
+    bool seen[256] = {false};
+    const uint8_t* ip = src + 2;
+    uint32_t cum = 0;
+    for (uint32_t i = 0; i < symbolCount; i++, ip += 3) {
+        uint8_t symbol = ip[0];
+        uint32_t f = readLE16(ip + 1);
+        if (seen[symbol] || f == 0 || f == PROB_SCALE || f > PROB_SCALE - cum) {
+            return false;
+        }
+        seen[symbol] = true;
+        for (uint32_t j = 0; j < f; j++) {
+            table[cum + j] = slotEntry(f, j, symbol);
+        }
+        cum += f;
+    }
+    if (cum != PROB_SCALE) {
+        return false;
+    }
+
+    uint32_t state[WAYS];
+    for (unsigned k = 0; k < WAYS; k++, ip += 4) {
+        state[k] = readLE32(ip);
+        if (state[k] < STATE_LOW) {
+            return false;
+        }
+    }
+    const uint8_t* wp = ip;
+    const uint8_t* wordsEnd = src + srcSize;
+
+    // While a whole step's worth of words is left, the states renormalize
+    // without branches or bounds checks. The states live in locals: stores
+    // through dst could otherwise alias them and force reloads.
+    uint32_t x0 = state[0];
+    uint32_t x1 = state[1];
+    uint32_t x2 = state[2];
+    uint32_t x3 = state[3];
+    size_t i = 0;
+    for (; i + WAYS <= dstSize && wordsEnd - wp >= static_cast<ptrdiff_t>(2 * WAYS); i += WAYS) {
+        uint8_t s0 = decodeSymbol(table, x0);
+        uint8_t s1 = decodeSymbol(table, x1);
+        uint8_t s2 = decodeSymbol(table, x2);
+        uint8_t s3 = decodeSymbol(table, x3);
+        dst[i] = s0;
+        dst[i + 1] = s1;
+        dst[i + 2] = s2;
+        dst[i + 3] = s3;
+        renormalize(x0, wp);
+        renormalize(x1, wp);
+        renormalize(x2, wp);
+        renormalize(x3, wp);
+    }
+    state[0] = x0;
+    state[1] = x1;
+    state[2] = x2;
+    state[3] = x3;
+    for (; i < dstSize; i++) {
+        uint32_t& x = state[i & (WAYS - 1)];
+        dst[i] = decodeSymbol(table, x);
+        if (x < STATE_LOW) {
+            if (wordsEnd - wp < 2) {
+                return false;
+            }
+            x = (x << 16) | readLE16(wp);
+            wp += 2;
+        }
+    }
+
+    // A stream decoded to its true length returns every state to where the
+    // encoder started.
+    for (unsigned k = 0; k < WAYS; k++) {
+        if (state[k] != STATE_LOW) {
+            return false;
+        }
+    }
+    return wp == wordsEnd;
+}
@@ -0,0 +1,71 @@
+#ifndef RANS_CODER_H
+#define RANS_CODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file RANSCoder.h
+ * @brief Contains the RANSCoder class, a four-way interleaved rANS byte coder
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * Encoded block format, all integers little-endian:
+ *
+ *   symbolCount       u16, number of byte values in use (0 to 256)
+ *   symbols           symbolCount x (value u8, frequency u16), frequencies
+ *                     summing to 2^PROB_BITS, each below it
+ *   states            4 x u32, the final encoder states
+ *   words             u16 renormalization words in decode order
+ *
+ * Byte i of the input belongs to state i % 4, so the decoder advances four
+ * independent states per step.
+ *
+ * A symbol holding the whole range would cost no bits at all, so the encoder
+ * always leaves room for a second one and the decoder rejects such tables.
+ * Every symbol then costs more than 2^-PROB_BITS bits, which bounds the
+ * decoded size by the encoded one.
+ */
+
+/**
+ * @brief Entropy codes bytes with four interleaved 32-bit rANS states
+ *
+ * Compresses closer to the entropy than Huffman codes, at some cost in
+ * speed. Stateless; blocks are independent.
+ */
+class RANSCoder {
+public:
+    /// Precision of the symbol frequencies
+    static const unsigned PROB_BITS = 12;
+
+    /**
+     * @brief Returns the worst-case encoded size of size input bytes
+     */
+    static size_t maxEncodedSize(size_t size) { return 2 + 256 * 3 + 16 + 2 * size + 8; }
+
+    /**
+     * @brief Returns the largest decoded size a block of size bytes can have
+     */
+    static uint64_t maxDecodedSize(size_t size) { return static_cast<uint64_t>(size) * 8 << PROB_BITS; }
+
+    /**
+     * @brief Entropy codes a buffer into caller-provided memory
+     * @param data Input bytes
+     * @param size Number of input bytes
+     * @param out Output buffer of at least maxEncodedSize(size) bytes
+     * @return Number of bytes written
+     */
+    static size_t encode(const uint8_t* data, size_t size, uint8_t* out);
+
+    /**
+     * @brief Decodes a block whose decoded size is known in advance
+     * @param src Encoded bytes
+     * @param srcSize Number of encoded bytes
+     * @param dst Output buffer
+     * @param dstSize Exact decoded size
+     * @return true if the block is well formed and decodes to exactly dstSize bytes
+     */
+    static bool decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+};
+
+#endif // RANS_CODER_H
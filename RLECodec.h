@@ -0,0 +1,248 @@
+#ifndef RLE_CODEC_H
+#define RLE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include "RunScanner.h"
+
+/**
+ * @file RLECodec.h
+ * @brief Contains the run-length codec shared by the image and .samet coders
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * Stream format, a sequence of tokens:
+ *
+ *   0xFF value count      a run of count (1-255) copies of value
+ *   n    bytes[n + 1]     n + 1 literal bytes, for n from 0 to 254
+ *
+ * The encoder works on independent blocks of BlockSize bytes; tokens never
+ * span a block boundary. A literal is ended only where a run of at least
+ * MIN_RUN equal bytes begins, so every run token saves at least one byte and
+ * the output never exceeds maxEncodedSize().
+ */
+
+/**
+ * @brief Sink that writes the encoded bytes through a raw pointer
+ *
+ * The buffer must hold maxEncodedSize() bytes; nothing is checked or allocated.
+ */
+struct RLEBufferSink {
+    uint8_t* pos;
+
+    explicit RLEBufferSink(uint8_t* out) : pos(out) {}
+
+    void run(uint8_t value, size_t count) {
+        pos[0] = 0xFF;
+        pos[1] = value;
+        pos[2] = static_cast<uint8_t>(count);
+        pos += 3;
+    }
+
+    void literal(const uint8_t* data, size_t count) {
+        *pos++ = static_cast<uint8_t>(count - 1);
+        std::memcpy(pos, data, count);
+        pos += count;
+    }
+};
+
+/**
+ * @brief Sink that only counts the encoded size
+ */
+struct RLECountingSink {
+    size_t size;
+
+    RLECountingSink() : size(0) {}
+
+    void run(uint8_t, size_t) { size += 3; }
+    void literal(const uint8_t*, size_t count) { size += count + 1; }
+};
+
+/**
+ * @brief Piece of an encoded stream that starts on a token boundary
+ *
+ * Segments decode independently of each other once their output offsets
+ * are known.
+ */
+struct RLESegment {
+    size_t srcOffset;
+    size_t srcSize;
+    size_t dstOffset;
+    size_t dstSize;
+};
+
+/**
+ * @brief Run-length codec templated on its token limits and block size
+ * @tparam MaxRun Longest run token, at most 255
+ * @tparam MaxLiteral Longest literal token, at most 255
+ * @tparam BlockSize Size of the independent blocks the input is cut into
+ */
+template <size_t MaxRun = 255, size_t MaxLiteral = 255, size_t BlockSize = 1024>
+class RLECodec {
+    static_assert(MaxRun >= RunScanner::MIN_RUN && MaxRun <= 255, "run counts are stored in one byte");
+    static_assert(MaxLiteral >= 1 && MaxLiteral <= 255, "literal counts are stored in one byte below 0xFF");
+    static_assert(BlockSize >= 1, "blocks cannot be empty");
+
+public:
+    /**
+     * @brief Returns the exact worst-case encoded size, reached by data without runs
+     * @param size Number of input bytes
+     */
+    static size_t maxEncodedSize(size_t size) {
+        size_t fullBlocks = size / BlockSize;
+        size_t rest = size % BlockSize;
+        return size + fullBlocks * literalTokens(BlockSize) + literalTokens(rest);
+    }
+
+    /**
+     * @brief Returns the largest decoded size a stream of size bytes can have
+     *
+     * Reached by run tokens of MaxRun bytes only; literals never expand.
+     */
+    static uint64_t maxDecodedSize(size_t size) { return static_cast<uint64_t>(size / 3) * MaxRun + size % 3; }
+
+    /**
+     * @brief Encodes a buffer into a sink
+     * @param data Input bytes
+     * @param size Number of input bytes
+     * @param sink Object receiving run() and literal() calls in stream order
+     */
+    template <typename Sink>
+    static void encode(const uint8_t* data, size_t size, Sink& sink) {
+        for (size_t start = 0; start < size; start += BlockSize) {
+            encodeBlock(data + start, std::min(BlockSize, size - start), sink);
+        }
+    }
+
+    /**
+     * @brief Encodes a buffer into caller-provided memory
+     * @param data Input bytes
+     * @param size Number of input bytes
+     * @param out Output buffer of at least maxEncodedSize(size) bytes
+     * @return Number of bytes written
+     */
+    static size_t encode(const uint8_t* data, size_t size, uint8_t* out) {
+        RLEBufferSink sink(out);
+        encode(data, size, sink);
+        return static_cast<size_t>(sink.pos - out);
+    }
+
+    /**
+     * @brief Decodes a stream whose decoded size is known in advance
+     * @param src Encoded bytes
+     * @param srcSize Number of encoded bytes
+     * @param dst Output buffer
+     * @param dstSize Exact decoded size
+     * @return true if the stream is well formed and decodes to exactly dstSize bytes
+     */
+    static bool decode(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+        const uint8_t* srcEnd = src + srcSize;
+        uint8_t* dstEnd = dst + dstSize;
+        while (src < srcEnd) {
+            uint8_t control = *src++;
+            if (control == 0xFF) {
+                if (srcEnd - src < 2) {
+                    return false;
+                }
+                size_t count = src[1];
+                if (static_cast<size_t>(dstEnd - dst) < count) {
+                    return false;
+                }
+                std::memset(dst, src[0], count);
+                src += 2;
+                dst += count;
+            } else {
+                size_t count = static_cast<size_t>(control) + 1;
+                if (static_cast<size_t>(srcEnd - src) < count ||
+                    static_cast<size_t>(dstEnd - dst) < count) {
+                    return false;
+                }
+                std::memcpy(dst, src, count);
+                src += count;
+                dst += count;
+            }
+        }
+        return dst == dstEnd;
+    }
+
+    /**
+     * @brief Cuts a stream into segments at token boundaries without decoding it
+     *
+     * Only the control bytes are read: a run costs one look at its count and
+     * a literal is skipped whole. The decoded size of every segment is
+     * summed, and the prefix sum of those sizes gives each segment its
+     * output offset, so the segments can then be expanded in parallel.
+     * @param src Encoded bytes
+     * @param srcSize Number of encoded bytes
+     * @param segmentSize Encoded bytes per segment; a segment ends at the first token boundary past it
+     * @param segments Receives the segments in stream order
+     * @return Total decoded size, or SIZE_MAX if the stream ends inside a token
+     */
+    static size_t split(const uint8_t* src, size_t srcSize, size_t segmentSize,
+                        std::vector<RLESegment>& segments) {
+        segments.clear();
+        size_t pos = 0;
+        while (pos < srcSize) {
+            RLESegment segment = { pos, 0, 0, 0 };
+            size_t limit = srcSize - pos > segmentSize ? pos + segmentSize : srcSize;
+            size_t decoded = 0;
+            while (pos < limit) {
+                if (src[pos] == 0xFF) {
+                    if (srcSize - pos < 3) {
+                        return SIZE_MAX;
+                    }
+                    decoded += src[pos + 2];
+                    pos += 3;
+                } else {
+                    size_t count = static_cast<size_t>(src[pos]) + 1;
+                    if (srcSize - pos - 1 < count) {
+                        return SIZE_MAX;
+                    }
+                    decoded += count;
+                    pos += count + 1;
+                }
+            }
+            segment.srcSize = pos - segment.srcOffset;
+            segment.dstSize = decoded;
+            segments.push_back(segment);
+        }
+
+        size_t offset = 0;
+        for (size_t i = 0; i < segments.size(); i++) {
+            segments[i].dstOffset = offset;
+            offset += segments[i].dstSize;
+        }
+        return offset;
+    }
+
+private:
+    static size_t literalTokens(size_t size) {
+        return (size + MaxLiteral - 1) / MaxLiteral;
+    }
+
+    template <typename Sink>
+    static void encodeBlock(const uint8_t* data, size_t size, Sink& sink) {
+        size_t pos = 0;
+        while (pos < size) {
+            size_t count = RunScanner::runLength(data + pos, std::min(MaxRun, size - pos));
+            if (count >= RunScanner::MIN_RUN) {
+                sink.run(data[pos], count);
+                pos += count;
+                continue;
+            }
+
+            // Extend the literal up to the next run worth a token; only the
+            // bytes a single literal can reach need to be searched.
+            size_t window = std::min(MaxLiteral + RunScanner::MIN_RUN - 1, size - pos - 1);
+            size_t next = RunScanner::findRun(data + pos + 1, window) + 1;
+            size_t literal = std::min(std::min(MaxLiteral, size - pos), next);
+            sink.literal(data + pos, literal);
+            pos += literal;
+        }
+    }
+};
+
+#endif // RLE_CODEC_H
@@ -0,0 +1,117 @@
+#include "RandomAccessFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file RandomAccessFile.cpp
+ * @brief Implementation of RandomAccessFile class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+#ifdef _WIN32
+
+RandomAccessFile::RandomAccessFile() : length(0), handle(nullptr) {}
+
+bool RandomAccessFile::open(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    length = static_cast<uint64_t>(fileSize.QuadPart);
+    return true;
+}
+
+void RandomAccessFile::close() {
+    if (handle != nullptr) {
+        CloseHandle(handle);
+    }
+    handle = nullptr;
+    length = 0;
+}
+
+bool RandomAccessFile::readAt(uint64_t offset, void* buffer, size_t size) const {
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+        // An explicit offset in the OVERLAPPED structure makes the read positional.
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD read = 0;
+        if (!ReadFile(handle, out, chunk, &read, &overlapped) || read == 0) {
+            return false;
+        }
+        out += read;
+        offset += read;
+        size -= read;
+    }
+    return true;
+}
+
+#else
+
+RandomAccessFile::RandomAccessFile() : length(0), fd(-1) {}
+
+bool RandomAccessFile::open(const std::string& filename) {
+    close();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close();
+        return false;
+    }
+    length = static_cast<uint64_t>(info.st_size);
+    // Region decodes touch a few scattered blocks; read-ahead would be wasted.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+    return true;
+}
+
+void RandomAccessFile::close() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    length = 0;
+}
+
+bool RandomAccessFile::readAt(uint64_t offset, void* buffer, size_t size) const {
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+        ssize_t read = pread(fd, out, size, static_cast<off_t>(offset));
+        if (read <= 0) {
+            return false;
+        }
+        out += read;
+        offset += read;
+        size -= static_cast<size_t>(read);
+    }
+    return true;
+}
+
+#endif
+
+RandomAccessFile::~RandomAccessFile() {
+    close();
+}
@@ -0,0 +1,55 @@
+#ifndef RANDOM_ACCESS_FILE_H
+#define RANDOM_ACCESS_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file RandomAccessFile.h
+ * @brief Contains RandomAccessFile class, a read-only file read at explicit offsets
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+class RandomAccessFile {
+public:
+    RandomAccessFile();
+    ~RandomAccessFile();
+
+    RandomAccessFile(const RandomAccessFile&) = delete;
+    RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+
+    /**
+     * @brief Opens a file for reading, closing any previous one
+     * @param filename Path to the file
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Closes the file
+     */
+    void close();
+
+    /**
+     * @brief Reads exactly size bytes starting at offset
+     *
+     * Reads do not move a shared file position, so several threads may read
+     * different parts of the file at the same time.
+     * @return true if all bytes were read, false otherwise
+     */
+    bool readAt(uint64_t offset, void* buffer, size_t size) const;
+
+    uint64_t size() const { return length; }
+
+private:
+    uint64_t length;
+#ifdef _WIN32
+    void* handle;
+#else
+    int fd;
+#endif
+};
+
+#endif // RANDOM_ACCESS_FILE_H
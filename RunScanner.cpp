@@ -0,0 +1,226 @@
+#include "RunScanner.h"
+#include "CPUFeatures.h"
+#include <cstring>
+
+#ifdef CPU_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * @file RunScanner.cpp
+ * @brief Implementation of the RunScanner class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+typedef size_t (*ScanFunction)(const uint8_t* data, size_t limit);
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define RUN_SCANNER_SWAR 1
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, 8);
+    return value;
+}
+#endif
+
+size_t scanRunScalar(const uint8_t* data, size_t limit) {
+    size_t n = 1;
+#ifdef RUN_SCANNER_SWAR
+    // XOR against the broadcast byte; the first non-zero byte ends the run.
+    uint64_t pattern = data[0] * 0x0101010101010101ULL;
+    while (n + 8 <= limit) {
+        uint64_t diff = load64(data + n) ^ pattern;
+        if (diff != 0) {
+            return n + (__builtin_ctzll(diff) >> 3);
+        }
+        n += 8;
+    }
+#endif
+    while (n < limit && data[n] == data[0]) {
+        n++;
+    }
+    return n;
+}
+
+size_t scanStartScalar(const uint8_t* data, size_t limit) {
+    size_t k = 0;
+#ifdef RUN_SCANNER_SWAR
+    // A byte of w ^ (w >> 8) is zero where data[k] == data[k + 1]; a zero
+    // byte in all three differences marks four equal bytes.
+    while (k + 11 <= limit) {
+        uint64_t w1 = load64(data + k + 1);
+        uint64_t w2 = load64(data + k + 2);
+        uint64_t diff = (load64(data + k) ^ w1) | (w1 ^ w2) | (w2 ^ load64(data + k + 3));
+        uint64_t zero = (diff - 0x0101010101010101ULL) & ~diff & 0x8080808080808080ULL;
+        if (zero != 0) {
+            return k + (__builtin_ctzll(zero) >> 3);
+        }
+        k += 8;
+    }
+#endif
+    while (k + 3 < limit) {
+        if (data[k] == data[k + 1] && data[k + 1] == data[k + 2] && data[k + 2] == data[k + 3]) {
+            return k;
+        }
+        k++;
+    }
+    return limit;
+}
+
+#ifdef CPU_X86_SIMD
+
+TARGET_SSE2 size_t scanRunSSE2(const uint8_t* data, size_t limit) {
+    __m128i value = _mm_set1_epi8(static_cast<char>(data[0]));
+    size_t n = 1;
+    while (n + 16 <= limit) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + n));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, value)));
+        if (mask != 0xFFFF) {
+            return n + __builtin_ctz(~mask);
+        }
+        n += 16;
+    }
+    while (n < limit && data[n] == data[0]) {
+        n++;
+    }
+    return n;
+}
+
+TARGET_SSE2 size_t scanStartSSE2(const uint8_t* data, size_t limit) {
+    size_t k = 0;
+    while (k + 19 <= limit) {
+        const uint8_t* p = data + k;
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 3));
+        __m128i equal = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(b, c)),
+                                      _mm_cmpeq_epi8(c, d));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(equal));
+        if (mask != 0) {
+            return k + __builtin_ctz(mask);
+        }
+        k += 16;
+    }
+    return k + scanStartScalar(data + k, limit - k);
+}
+
+TARGET_AVX2 size_t scanRunAVX2(const uint8_t* data, size_t limit) {
+    __m256i value = _mm256_set1_epi8(static_cast<char>(data[0]));
+    size_t n = 1;
+    while (n + 64 <= limit) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + n));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + n + 32));
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, value))) |
+                        (static_cast<uint64_t>(static_cast<uint32_t>(
+                             _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, value)))) << 32);
+        if (mask != ~0ULL) {
+            return n + __builtin_ctzll(~mask);
+        }
+        n += 64;
+    }
+    if (n + 32 <= limit) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + n));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, value)));
+        if (mask != 0xFFFFFFFFu) {
+            return n + __builtin_ctz(~mask);
+        }
+        n += 32;
+    }
+    if (n < limit && limit >= 32) {
+        // One last window ending at the limit; the bytes before n that it
+        // overlaps are already known to match.
+        size_t last = limit - 32;
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + last));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, value)));
+        return mask == 0xFFFFFFFFu ? limit : last + __builtin_ctz(~mask);
+    }
+    // Short inputs: finish here, since calling the SSE2 version from AVX2
+    // code would pay for mixing VEX and legacy encodings on every call.
+    while (n < limit && data[n] == data[0]) {
+        n++;
+    }
+    return n;
+}
+
+TARGET_AVX2 inline uint32_t runStartMask(const uint8_t* p) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 2));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 3));
+    __m256i equal = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(b, c)),
+                                     _mm256_cmpeq_epi8(c, d));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+}
+
+TARGET_AVX2 size_t scanStartAVX2(const uint8_t* data, size_t limit) {
+    size_t k = 0;
+    while (k + 67 <= limit) {
+        uint64_t mask = runStartMask(data + k) |
+                        (static_cast<uint64_t>(runStartMask(data + k + 32)) << 32);
+        if (mask != 0) {
+            return k + __builtin_ctzll(mask);
+        }
+        k += 64;
+    }
+    if (k + 35 <= limit) {
+        uint32_t mask = runStartMask(data + k);
+        if (mask != 0) {
+            return k + __builtin_ctz(mask);
+        }
+        k += 32;
+    }
+    if (k + 3 < limit && limit >= 35) {
+        // One last window ending at the limit; positions before k that it
+        // overlaps are already known not to start a run.
+        size_t last = limit - 35;
+        uint32_t mask = runStartMask(data + last);
+        return mask == 0 ? limit : last + __builtin_ctz(mask);
+    }
+    while (k + 3 < limit) {
+        if (data[k] == data[k + 1] && data[k + 1] == data[k + 2] && data[k + 2] == data[k + 3]) {
+            return k;
+        }
+        k++;
+    }
+    return limit;
+}
+
+#endif // CPU_X86_SIMD
+
+ScanFunction selectRun() {
+#ifdef CPU_X86_SIMD
+    const CPUFeatures& cpu = CPUFeatures::get();
+    if (cpu.avx2) {
+        return scanRunAVX2;
+    }
+    if (cpu.sse2) {
+        return scanRunSSE2;
+    }
+#endif
+    return scanRunScalar;
+}
+
+ScanFunction selectStart() {
+#ifdef CPU_X86_SIMD
+    const CPUFeatures& cpu = CPUFeatures::get();
+    if (cpu.avx2) {
+        return scanStartAVX2;
+    }
+    if (cpu.sse2) {
+        return scanStartSSE2;
+    }
+#endif
+    return scanStartScalar;
+}
+
+} // namespace
+
+const RunScanner::ScanFunction RunScanner::scanRun = selectRun();
+const RunScanner::ScanFunction RunScanner::scanStart = selectStart();
+
+const size_t RunScanner::MIN_RUN;
@@ -0,0 +1,59 @@
+#ifndef RUN_SCANNER_H
+#define RUN_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file RunScanner.h
+ * @brief Vectorized search primitives for the run-length coders
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Locates runs of equal bytes
+ *
+ * Both scans compare 64 bytes per step with AVX2, or 16 with SSE2, and find
+ * the first boundary with a movemask and a count of trailing zeros. A scalar
+ * word-at-a-time version is used on other CPUs; every version returns the same
+ * result. The implementation is picked once at startup.
+ */
+class RunScanner {
+public:
+    /**
+     * @brief Counts the leading bytes equal to data[0]
+     * @param data Pointer to the bytes
+     * @param limit Maximum count and number of readable bytes, at least 1
+     * @return Length of the run, between 1 and limit
+     */
+    static size_t runLength(const uint8_t* data, size_t limit) {
+        // Noisy data breaks the run after one byte; skip the call then.
+        if (limit < 2 || data[1] != data[0]) {
+            return 1;
+        }
+        return scanRun(data, limit);
+    }
+
+    /**
+     * @brief Finds the first position where a run of MIN_RUN equal bytes begins
+     * @param data Pointer to the bytes
+     * @param limit Number of readable bytes
+     * @return Smallest k with k + 3 < limit and data[k..k + 3] all equal,
+     *         or limit if there is none
+     */
+    static size_t findRun(const uint8_t* data, size_t limit) {
+        return scanStart(data, limit);
+    }
+
+    /// Shortest run findRun() looks for
+    static const size_t MIN_RUN = 4;
+
+private:
+    typedef size_t (*ScanFunction)(const uint8_t* data, size_t limit);
+
+    static const ScanFunction scanRun;
+    static const ScanFunction scanStart;
+};
+
+#endif // RUN_SCANNER_H
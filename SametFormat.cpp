@@ -0,0 +1,124 @@
+#include "SametFormat.h"
+#include "CRC32.h"
+#include <cstring>
+
+/**
+ * @file SametFormat.cpp
+ * @brief Implementation of the .samet container structures
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+inline void writeLE16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void writeLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+inline void writeLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+inline uint16_t readLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLE32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+inline uint64_t readLE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+} // namespace
+
+const uint8_t SametHeader::MAGIC[4] = {'S', 'A', 'M', 'T'};
+const uint16_t SametHeader::VERSION;
+const size_t SametHeader::SIZE;
+const size_t SametBlockEntry::SIZE;
+
+void SametHeader::serialize(uint8_t* out) const {
+    std::memcpy(out, MAGIC, 4);
+    writeLE16(out + 4, version);
+    out[6] = static_cast<uint8_t>(codec);
+    out[7] = flags;
+    writeLE32(out + 8, width);
+    writeLE32(out + 12, height);
+    out[16] = channels;
+    out[17] = bitDepth;
+    writeLE16(out + 18, tileSize);
+    writeLE32(out + 20, blockSize);
+    writeLE32(out + 24, blockCount);
+    writeLE64(out + 28, rawSize);
+    writeLE64(out + 36, indexOffset);
+    writeLE32(out + 44, CRC32::update(0, out, 44));
+}
+
+bool SametHeader::parse(const uint8_t* in, size_t size) {
+    if (size < SIZE || !hasMagic(in, size)) {
+        return false;
+    }
+    if (readLE32(in + 44) != CRC32::update(0, in, 44)) {
+        return false;
+    }
+
+    version = readLE16(in + 4);
+    codec = static_cast<SametCodec>(in[6]);
+    flags = in[7];
+    width = readLE32(in + 8);
+    height = readLE32(in + 12);
+    channels = in[16];
+    bitDepth = in[17];
+    tileSize = readLE16(in + 18);
+    blockSize = readLE32(in + 20);
+    blockCount = readLE32(in + 24);
+    rawSize = readLE64(in + 28);
+    indexOffset = readLE64(in + 36);
+    return version == VERSION;
+}
+
+bool SametHeader::hasMagic(const uint8_t* in, size_t size) {
+    return size >= 4 && std::memcmp(in, MAGIC, 4) == 0;
+}
+
+void SametBlockEntry::serialize(uint8_t* out) const {
+    writeLE64(out, rawOffset);
+    writeLE64(out + 8, compressedOffset);
+    writeLE32(out + 16, rawSize);
+    writeLE32(out + 20, compressedSize);
+    writeLE32(out + 24, checksum);
+    out[28] = static_cast<uint8_t>(codec);
+    out[29] = static_cast<uint8_t>(entropy);
+    out[30] = static_cast<uint8_t>(predictor);
+    out[31] = static_cast<uint8_t>(color);
+}
+
+void SametBlockEntry::parse(const uint8_t* in) {
+    rawOffset = readLE64(in);
+    compressedOffset = readLE64(in + 8);
+    rawSize = readLE32(in + 16);
+    compressedSize = readLE32(in + 20);
+    checksum = readLE32(in + 24);
+    codec = static_cast<SametCodec>(in[28]);
+    entropy = static_cast<SametEntropy>(in[29]);
+    predictor = static_cast<SametPredictor>(in[30]);
+    color = static_cast<SametColorTransform>(in[31]);
+}
@@ -0,0 +1,137 @@
+#ifndef SAMET_FORMAT_H
+#define SAMET_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file SametFormat.h
+ * @brief Contains the on-disk structures of the binary .samet container (version 2)
+ * @author Samet Aydın
+ * @date 2025
+ *
+ * Layout of a version 2 file, all integers little-endian:
+ *
+ *   SametHeader          48 bytes, fixed
+ *   block payloads       compressed blocks, back to back
+ *   SametBlockEntry[n]   32 bytes each, one per block
+ *   index CRC-32         4 bytes, over the entries
+ *
+ * The header records where the index starts, so the metadata and the location
+ * of any block can be read without touching the payload.
+ *
+ * The pixel data is either cut into consecutive blocks of blockSize bytes, or,
+ * when tileSize is non-zero, into square tiles of tileSize pixels stored row
+ * by row of tiles. Each tile is one block holding its own rows back to back;
+ * tiles on the right and bottom edges are narrower or shorter.
+ */
+
+// Codec used to compress a block
+enum class SametCodec : uint8_t {
+    RAW = 0,
+    RLE = 1,
+    LZ = 2
+};
+
+// Entropy coder applied to a block after its codec
+enum class SametEntropy : uint8_t {
+    NONE = 0,
+    HUFFMAN = 1,
+    RANS = 2
+};
+
+// Spatial predictor applied to the rows of a block before its codec
+enum class SametPredictor : uint8_t {
+    NONE = 0,
+    LEFT = 1,
+    UP = 2,
+    AVERAGE = 3,
+    MED = 4     // median edge detector of LOCO-I
+};
+
+// Reversible color transform applied to the pixels of a block before prediction
+enum class SametColorTransform : uint8_t {
+    NONE = 0,
+    YCOCG_R = 1
+};
+
+// Fixed-size file header
+struct SametHeader {
+    static const uint8_t MAGIC[4];
+    static const uint16_t VERSION = 2;
+    static const size_t SIZE = 48;
+
+    uint16_t version;
+    SametCodec codec;       // codec of the blocks unless an entry says otherwise
+    uint8_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;
+    uint8_t bitDepth;
+    uint16_t tileSize;      // tile edge in pixels, 0 for a linear layout
+    uint32_t blockSize;     // uncompressed bytes per block, the last may be shorter
+    uint32_t blockCount;
+    uint64_t rawSize;       // total uncompressed size
+    uint64_t indexOffset;   // file offset of the first SametBlockEntry
+
+    /**
+     * @brief Writes the header, including its CRC, to SIZE bytes at out
+     */
+    void serialize(uint8_t* out) const;
+
+    /**
+     * @brief Reads a header and checks its magic, version and CRC
+     * @param in Pointer to the first byte of the file
+     * @param size Number of bytes available
+     * @return true if the header is valid, false otherwise
+     */
+    bool parse(const uint8_t* in, size_t size);
+
+    /**
+     * @brief Tells whether the bytes start with the version 2 magic
+     */
+    static bool hasMagic(const uint8_t* in, size_t size);
+
+    /**
+     * @brief Returns the number of bytes of one full row of pixels
+     */
+    size_t rowBytes() const { return (static_cast<size_t>(width) * channels * bitDepth + 7) / 8; }
+
+    /**
+     * @brief Returns the number of tile columns, 0 for a linear layout
+     */
+    uint32_t tilesAcross() const { return tileSize ? (width + tileSize - 1) / tileSize : 0; }
+
+    /**
+     * @brief Returns the number of tile rows, 0 for a linear layout
+     */
+    uint32_t tilesDown() const { return tileSize ? (height + tileSize - 1) / tileSize : 0; }
+};
+
+// Index entry locating one block
+struct SametBlockEntry {
+    static const size_t SIZE = 32;
+
+    uint64_t rawOffset;         // offset in the uncompressed pixel data
+    uint64_t compressedOffset;  // offset in the file
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    uint32_t checksum;          // CRC-32 of the uncompressed pixels
+    SametCodec codec;
+    SametEntropy entropy;       // if not NONE, the payload is the codec output's
+                                // size (u32) followed by its entropy coding
+    SametPredictor predictor;   // if not NONE, the block holds whole rows of
+    SametColorTransform color;  // residuals rather than pixels
+
+    /**
+     * @brief Writes the entry to SIZE bytes at out
+     */
+    void serialize(uint8_t* out) const;
+
+    /**
+     * @brief Reads an entry from SIZE bytes at in
+     */
+    void parse(const uint8_t* in);
+};
+
+#endif // SAMET_FORMAT_H
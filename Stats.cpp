@@ -0,0 +1,207 @@
+#include "Stats.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file Stats.cpp
+ * @brief Implementation of Stats class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+const size_t Stats::STAGE_COUNT;
+const size_t Stats::COUNTER_COUNT;
+thread_local Stats::Slot* Stats::current = nullptr;
+
+namespace {
+
+const char* const STAGE_NAMES[] = {
+    "file_read", "file_write", "png_decode", "png_chunks", "png_inflate", "png_unfilter",
+    "png_encode", "png_filter", "png_deflate", "samet_encode", "samet_decode", "block_encode", "block_decode"
+};
+
+const char* const COUNTER_NAMES[] = {
+    "png_chunks", "blocks_encoded", "blocks_decoded", "files_ok", "files_failed"
+};
+
+static_assert(sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) == Stats::STAGE_COUNT, "one name per stage");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == Stats::COUNTER_COUNT, "one name per counter");
+
+} // namespace
+
+// The registry is allocated once and never freed: pool threads may still
+// return their slots while static objects are being destroyed.
+struct SlotRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Stats::Slot> > slots;
+
+    static SlotRegistry& get() {
+        static SlotRegistry* registry = new SlotRegistry();
+        return *registry;
+    }
+};
+
+// Hands the slot of a thread back to the registry when the thread exits.
+struct SlotOwner {
+    Stats::Slot* slot;
+
+    SlotOwner() : slot(nullptr) {}
+    ~SlotOwner() {
+        Stats::current = nullptr;
+        if (slot) {
+            Stats::detach(slot);
+        }
+    }
+};
+
+Stats::Slot& Stats::attach() {
+    SlotRegistry& registry = SlotRegistry::get();
+    Slot* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (size_t i = 0; i < registry.slots.size() && !slot; i++) {
+            if (!registry.slots[i]->inUse) {
+                slot = registry.slots[i].get();
+            }
+        }
+        if (!slot) {
+            registry.slots.emplace_back(new Slot());
+            slot = registry.slots.back().get();
+            for (size_t i = 0; i < STAGE_COUNT * 4; i++) {
+                slot->stages[i].store(0, std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < COUNTER_COUNT; i++) {
+                slot->counters[i].store(0, std::memory_order_relaxed);
+            }
+        }
+        slot->inUse = true;
+    }
+
+    thread_local SlotOwner owner;
+    owner.slot = slot;
+    current = slot;
+    return *slot;
+}
+
+void Stats::detach(Slot* slot) {
+    SlotRegistry& registry = SlotRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    slot->inUse = false;
+}
+
+Stats::Snapshot Stats::snapshot() {
+    Snapshot totals = {};
+    SlotRegistry& registry = SlotRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t s = 0; s < registry.slots.size(); s++) {
+        const Slot& slot = *registry.slots[s];
+        for (size_t i = 0; i < STAGE_COUNT; i++) {
+            totals.stages[i].calls += slot.stages[i * 4].load(std::memory_order_relaxed);
+            totals.stages[i].nanoseconds += slot.stages[i * 4 + 1].load(std::memory_order_relaxed);
+            totals.stages[i].bytesIn += slot.stages[i * 4 + 2].load(std::memory_order_relaxed);
+            totals.stages[i].bytesOut += slot.stages[i * 4 + 3].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < COUNTER_COUNT; i++) {
+            totals.counters[i] += slot.counters[i].load(std::memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+void Stats::reset() {
+    // Meant for quiet moments; a thread recording at the same time may
+    // write back a total read before the reset.
+    SlotRegistry& registry = SlotRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t s = 0; s < registry.slots.size(); s++) {
+        Slot& slot = *registry.slots[s];
+        for (size_t i = 0; i < STAGE_COUNT * 4; i++) {
+            slot.stages[i].store(0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < COUNTER_COUNT; i++) {
+            slot.counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+const char* Stats::stageName(Stage stage) {
+    return STAGE_NAMES[static_cast<size_t>(stage)];
+}
+
+const char* Stats::counterName(Counter counter) {
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+void Stats::writeJSON(std::ostream& out, const Snapshot& totals) {
+    out << "{\n  \"stages\": {\n";
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        const StageTotals& stage = totals.stages[i];
+        out << "    \"" << STAGE_NAMES[i] << "\": {\"calls\": " << stage.calls
+            << ", \"seconds\": " << std::fixed << std::setprecision(6) << stage.nanoseconds / 1e9
+            << ", \"bytes_in\": " << stage.bytesIn << ", \"bytes_out\": " << stage.bytesOut << "}"
+            << (i + 1 < STAGE_COUNT ? "," : "") << "\n";
+    }
+    out << "  },\n  \"counters\": {\n";
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        out << "    \"" << COUNTER_NAMES[i] << "\": " << totals.counters[i]
+            << (i + 1 < COUNTER_COUNT ? "," : "") << "\n";
+    }
+    out << "  }\n}\n";
+}
+
+void Stats::writePrometheus(std::ostream& out, const Snapshot& totals) {
+    struct Metric {
+        const char* name;
+        const char* help;
+    };
+    const Metric metrics[] = {
+        {"image_compressor_stage_calls_total", "Calls of each stage"},
+        {"image_compressor_stage_seconds_total", "Time spent in each stage"},
+        {"image_compressor_stage_bytes_in_total", "Bytes consumed by each stage"},
+        {"image_compressor_stage_bytes_out_total", "Bytes produced by each stage"}
+    };
+    for (size_t m = 0; m < 4; m++) {
+        out << "# HELP " << metrics[m].name << " " << metrics[m].help << "\n"
+            << "# TYPE " << metrics[m].name << " counter\n";
+        for (size_t i = 0; i < STAGE_COUNT; i++) {
+            const StageTotals& stage = totals.stages[i];
+            out << metrics[m].name << "{stage=\"" << STAGE_NAMES[i] << "\"} ";
+            switch (m) {
+                case 0: out << stage.calls; break;
+                case 1: out << std::fixed << std::setprecision(6) << stage.nanoseconds / 1e9; break;
+                case 2: out << stage.bytesIn; break;
+                default: out << stage.bytesOut; break;
+            }
+            out << "\n";
+        }
+    }
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        out << "# TYPE image_compressor_" << COUNTER_NAMES[i] << "_total counter\n"
+            << "image_compressor_" << COUNTER_NAMES[i] << "_total " << totals.counters[i] << "\n";
+    }
+}
+
+bool Stats::save(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cout << "Error: Cannot create stats file " << filename << std::endl;
+        return false;
+    }
+    Snapshot totals = snapshot();
+    bool prometheus = filename.length() >= 5 && filename.compare(filename.length() - 5, 5, ".prom") == 0;
+    if (prometheus) {
+        writePrometheus(file, totals);
+    } else {
+        writeJSON(file, totals);
+    }
+    file.close();
+    if (file.fail()) {
+        std::cout << "Error: Failed to write stats file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
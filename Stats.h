@@ -0,0 +1,203 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/**
+ * @file Stats.h
+ * @brief Contains Stats class and ScopedTimer for counting work per stage
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+// Stages of decoding and encoding whose calls, time and bytes are recorded
+enum class Stage {
+    FILE_READ,      // whole input files read by the batch pipeline
+    FILE_WRITE,     // whole output files written by the batch pipeline
+    PNG_DECODE,     // PNG file to pixels, including the stages below
+    PNG_CHUNKS,     // chunk table walk with CRC checks
+    PNG_INFLATE,
+    PNG_UNFILTER,
+    PNG_ENCODE,     // pixels to PNG file, including the stages below
+    PNG_FILTER,
+    PNG_DEFLATE,
+    SAMET_ENCODE,   // pixels to .samet file, including block encoding
+    SAMET_DECODE,   // .samet file to pixels, including block decoding
+    BLOCK_ENCODE,   // one .samet block through predictor, codec and entropy coder
+    BLOCK_DECODE,
+    COUNT
+};
+
+// Plain event counts
+enum class Counter {
+    PNG_CHUNKS,
+    BLOCKS_ENCODED,
+    BLOCKS_DECODED,
+    FILES_OK,
+    FILES_FAILED,
+    COUNT
+};
+
+/**
+ * @brief Process-wide counters and stage timings
+ *
+ * Every thread writes to its own slot, so recording is a pair of relaxed
+ * loads and stores with no shared cache line and no lock. snapshot() sums
+ * the slots of all threads. Slots of finished threads are kept, with their
+ * totals, for the next thread to start. Building with
+ * -DIMAGE_COMPRESSOR_NO_STATS turns every recording call into a no-op.
+ */
+class Stats {
+public:
+    static const size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);
+    static const size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+    struct StageTotals {
+        uint64_t calls;
+        uint64_t nanoseconds;
+        uint64_t bytesIn;
+        uint64_t bytesOut;
+    };
+
+    struct Snapshot {
+        StageTotals stages[STAGE_COUNT];
+        uint64_t counters[COUNTER_COUNT];
+    };
+
+    /**
+     * @brief Adds to an event counter
+     */
+    static void add(Counter counter, uint64_t value = 1) {
+#ifndef IMAGE_COMPRESSOR_NO_STATS
+        bump(local().counters[static_cast<size_t>(counter)], value);
+#else
+        (void)counter;
+        (void)value;
+#endif
+    }
+
+    /**
+     * @brief Records one call of a stage
+     * @param stage Stage that ran
+     * @param nanoseconds Time the call took
+     * @param bytesIn Bytes it consumed
+     * @param bytesOut Bytes it produced
+     */
+    static void record(Stage stage, uint64_t nanoseconds, uint64_t bytesIn, uint64_t bytesOut) {
+#ifndef IMAGE_COMPRESSOR_NO_STATS
+        Slot& slot = local();
+        size_t index = static_cast<size_t>(stage) * 4;
+        bump(slot.stages[index], 1);
+        bump(slot.stages[index + 1], nanoseconds);
+        bump(slot.stages[index + 2], bytesIn);
+        bump(slot.stages[index + 3], bytesOut);
+#else
+        (void)stage;
+        (void)nanoseconds;
+        (void)bytesIn;
+        (void)bytesOut;
+#endif
+    }
+
+    /**
+     * @brief Sums the totals of every thread
+     */
+    static Snapshot snapshot();
+
+    /**
+     * @brief Sets every total back to zero
+     */
+    static void reset();
+
+    static const char* stageName(Stage stage);
+    static const char* counterName(Counter counter);
+
+    /**
+     * @brief Writes a snapshot as one JSON object
+     */
+    static void writeJSON(std::ostream& out, const Snapshot& totals);
+
+    /**
+     * @brief Writes a snapshot in the Prometheus text exposition format
+     */
+    static void writePrometheus(std::ostream& out, const Snapshot& totals);
+
+    /**
+     * @brief Writes the current totals to a file, as Prometheus text when the
+     *        name ends in .prom and as JSON otherwise
+     * @return true if successful, false otherwise
+     */
+    static bool save(const std::string& filename);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> stages[STAGE_COUNT * 4];
+        std::atomic<uint64_t> counters[COUNTER_COUNT];
+        bool inUse;
+    };
+
+    static thread_local Slot* current;
+
+    // Only the owning thread writes a slot, so no read-modify-write is needed;
+    // the atomics just make the concurrent reads of snapshot() well defined.
+    static void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static Slot& local() { return current ? *current : attach(); }
+    static Slot& attach();
+    static void detach(Slot* slot);
+
+    friend struct SlotRegistry;
+    friend struct SlotOwner;
+};
+
+/**
+ * @brief Records the time from construction to destruction as one call of a stage
+ */
+class ScopedTimer {
+public:
+#ifndef IMAGE_COMPRESSOR_NO_STATS
+    explicit ScopedTimer(Stage stage)
+        : stage(stage), bytesIn(0), bytesOut(0), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        Stats::record(stage, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                      bytesIn, bytesOut);
+    }
+#else
+    explicit ScopedTimer(Stage) {}
+#endif
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    /**
+     * @brief Sets the bytes consumed and produced by the timed call
+     */
+    void setBytes(uint64_t in, uint64_t out) {
+#ifndef IMAGE_COMPRESSOR_NO_STATS
+        bytesIn = in;
+        bytesOut = out;
+#else
+        (void)in;
+        (void)out;
+#endif
+    }
+
+#ifndef IMAGE_COMPRESSOR_NO_STATS
+private:
+    Stage stage;
+    uint64_t bytesIn;
+    uint64_t bytesOut;
+    std::chrono::steady_clock::time_point start;
+#endif
+};
+
+#endif // STATS_H
@@ -0,0 +1,154 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <memory>
+
+/**
+ * @file ThreadPool.cpp
+ * @brief Implementation of ThreadPool class
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+// Identifies the pool and queue of the worker running on this thread, so that
+// tasks submitted from inside a task land on the submitter's own deque.
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threadCount) : pending(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.emplace_back(new WorkerQueue());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t index = currentPool == this ? currentQueue
+                                       : nextQueue.fetch_add(1) % queues.size();
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+
+    // Taking the sleep lock orders the increment before any waiter's check.
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    available.notify_one();
+}
+
+bool ThreadPool::takeTask(size_t index, std::function<void()>& task) {
+    {
+        WorkerQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkerQueue& victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+
+    for (;;) {
+        std::function<void()> task;
+        if (takeTask(index, task)) {
+            pending.fetch_sub(1);
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        available.wait(lock, [this] { return stopping || pending.load() > 0; });
+        if (stopping && pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t ranges = (count + grain - 1) / grain;
+    if (ranges == 1 || workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    // Ranges are claimed through a shared counter by the caller and by up to
+    // one helper per worker; whoever finishes the last range wakes the caller.
+    struct Loop {
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    std::shared_ptr<Loop> loop = std::make_shared<Loop>();
+    loop->next = 0;
+    loop->done = 0;
+
+    auto run = [loop, ranges, count, grain, &fn]() {
+        for (;;) {
+            size_t index = loop->next.fetch_add(1);
+            if (index >= ranges) {
+                return;
+            }
+            size_t begin = index * grain;
+            fn(begin, std::min(count, begin + grain));
+            if (loop->done.fetch_add(1) + 1 == ranges) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), ranges - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&loop, ranges] { return loop->done.load() == ranges; });
+}
@@ -0,0 +1,83 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file ThreadPool.h
+ * @brief Contains ThreadPool class for running data-parallel loops
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+/**
+ * @brief Work-stealing pool of worker threads
+ *
+ * Every worker owns a task deque. Tasks submitted from a worker go to the back
+ * of its own deque and are taken back LIFO, which keeps nested work on the
+ * cache that produced it; idle workers steal from the front of the other
+ * deques, so uneven tasks still spread over all cores.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor
+     * @param threadCount Number of worker threads, 0 for one per hardware thread
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Stops and joins all worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the process-wide pool sized to the hardware
+     */
+    static ThreadPool& shared();
+
+    size_t getThreadCount() const { return workers.size(); }
+
+    /**
+     * @brief Runs fn over [0, count) split into ranges of at most grain items
+     *
+     * The calling thread takes part in the work, so the call is safe from
+     * inside a task and returns only when every range has been processed.
+     *
+     * @param count Number of items
+     * @param grain Maximum number of items per range
+     * @param fn Callback receiving a half-open range [begin, end)
+     */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue> > queues;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> nextQueue;
+    std::mutex sleepMutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void workerLoop(size_t index);
+    void submit(std::function<void()> task);
+    bool takeTask(size_t index, std::function<void()>& task);
+};
+
+#endif // THREAD_POOL_H
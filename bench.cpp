@@ -0,0 +1,625 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <streambuf>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "PNGImage.h"
+#include "ImageCompressor.h"
+#include "PNGRowReader.h"
+#include "PNGFilter.h"
+#include "FilterSelector.h"
+#include "Inflater.h"
+#include "Deflater.h"
+#include "CRC32.h"
+#include "RandomAccessFile.h"
+
+/**
+ * @file bench.cpp
+ * @brief Benchmark of every decoding and encoding stage over a synthetic corpus
+ * @author Samet Aydın
+ * @date 2025
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Stream buffer that discards everything written to it
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// xorshift64*: the same sequence on every platform and standard library,
+// unlike the std:: distributions.
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>((next() >> 32) % bound); }
+
+private:
+    uint64_t state;
+};
+
+struct CorpusImage {
+    std::string name;
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> png;
+};
+
+inline uint8_t clampByte(double value) {
+    return static_cast<uint8_t>(std::min(255.0, std::max(0.0, value)));
+}
+
+// Solid rectangles with borders and rows of small glyph-like marks, the
+// long flat runs of screenshots and UI captures.
+void drawFlatUI(CorpusImage& image, Random& random) {
+    size_t ch = image.channels;
+    std::vector<uint8_t> color(ch);
+    for (size_t c = 0; c < ch; c++) {
+        color[c] = static_cast<uint8_t>(224 + random.below(32));
+    }
+    for (size_t i = 0; i < image.pixels.size(); i++) {
+        image.pixels[i] = color[i % ch];
+    }
+
+    auto fill = [&](uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, const std::vector<uint8_t>& value) {
+        for (uint32_t y = y0; y < std::min(y0 + h, image.height); y++) {
+            for (uint32_t x = x0; x < std::min(x0 + w, image.width); x++) {
+                std::memcpy(&image.pixels[(static_cast<size_t>(y) * image.width + x) * ch], value.data(), ch);
+            }
+        }
+    };
+
+    uint32_t panels = 4 + (image.width * image.height) / 40000;
+    std::vector<uint8_t> border(ch, 96);
+    std::vector<uint8_t> ink(ch, 32);
+    for (uint32_t p = 0; p < panels; p++) {
+        uint32_t w = 16 + random.below(std::max(image.width / 3, 1u));
+        uint32_t h = 12 + random.below(std::max(image.height / 4, 1u));
+        uint32_t x = random.below(image.width);
+        uint32_t y = random.below(image.height);
+        for (size_t c = 0; c < ch; c++) {
+            color[c] = static_cast<uint8_t>(random.below(256));
+        }
+        fill(x, y, w, h, border);
+        fill(x + 1, y + 1, w - 2, h - 2, color);
+        for (uint32_t line = y + 6; line + 8 < y + h; line += 12) {
+            for (uint32_t gx = x + 4; gx + 6 < x + w; gx += 7) {
+                if (random.below(4) != 0) {
+                    fill(gx, line, 1 + random.below(5), 1 + random.below(7), ink);
+                }
+            }
+        }
+    }
+}
+
+// Smooth ramps in different directions per channel.
+void drawGradient(CorpusImage& image, Random& random) {
+    size_t ch = image.channels;
+    std::vector<double> dx(ch), dy(ch), base(ch);
+    for (size_t c = 0; c < ch; c++) {
+        dx[c] = (random.below(512) - 256.0) / image.width;
+        dy[c] = (random.below(512) - 256.0) / image.height;
+        base[c] = random.below(256);
+    }
+    for (uint32_t y = 0; y < image.height; y++) {
+        for (uint32_t x = 0; x < image.width; x++) {
+            for (size_t c = 0; c < ch; c++) {
+                double value = std::fmod(base[c] + dx[c] * x + dy[c] * y + 512.0, 256.0);
+                image.pixels[(static_cast<size_t>(y) * image.width + x) * ch + c] = static_cast<uint8_t>(value);
+            }
+        }
+    }
+}
+
+// Incompressible bytes, the worst case of every codec.
+void drawNoise(CorpusImage& image, Random& random) {
+    for (size_t i = 0; i < image.pixels.size(); i++) {
+        image.pixels[i] = static_cast<uint8_t>(random.next() >> 56);
+    }
+}
+
+// Several octaves of interpolated value noise plus sensor-like grain:
+// smooth areas, soft edges and a noisy low bit, as in photographs.
+void drawPhoto(CorpusImage& image, Random& random) {
+    size_t ch = image.channels;
+    const int octaves = 4;
+    std::vector<std::vector<double> > grids(octaves);
+    std::vector<uint32_t> cells(octaves);
+    for (int o = 0; o < octaves; o++) {
+        cells[o] = 4u << (2 * o);
+        grids[o].resize((cells[o] + 1) * (cells[o] + 1) * ch);
+        for (size_t i = 0; i < grids[o].size(); i++) {
+            grids[o][i] = random.below(1024) / 1024.0 - 0.5;
+        }
+    }
+
+    for (uint32_t y = 0; y < image.height; y++) {
+        for (uint32_t x = 0; x < image.width; x++) {
+            for (size_t c = 0; c < ch; c++) {
+                double value = 128.0;
+                double amplitude = 160.0;
+                for (int o = 0; o < octaves; o++) {
+                    double gx = static_cast<double>(x) * cells[o] / image.width;
+                    double gy = static_cast<double>(y) * cells[o] / image.height;
+                    uint32_t ix = static_cast<uint32_t>(gx);
+                    uint32_t iy = static_cast<uint32_t>(gy);
+                    double fx = gx - ix;
+                    double fy = gy - iy;
+                    size_t row = cells[o] + 1;
+                    const std::vector<double>& g = grids[o];
+                    double top = g[(iy * row + ix) * ch + c] * (1 - fx) + g[(iy * row + ix + 1) * ch + c] * fx;
+                    double bottom = g[((iy + 1) * row + ix) * ch + c] * (1 - fx) +
+                                    g[((iy + 1) * row + ix + 1) * ch + c] * fx;
+                    value += amplitude * (top * (1 - fy) + bottom * fy);
+                    amplitude *= 0.45;
+                }
+                value += static_cast<int>(random.below(7)) - 3;
+                image.pixels[(static_cast<size_t>(y) * image.width + x) * ch + c] = clampByte(value);
+            }
+        }
+    }
+}
+
+void buildCorpus(bool quick, std::vector<CorpusImage>& corpus) {
+    struct Kind {
+        const char* name;
+        void (*draw)(CorpusImage&, Random&);
+    };
+    const Kind kinds[] = {
+        {"flat_ui", drawFlatUI}, {"gradient", drawGradient}, {"noise", drawNoise}, {"photo", drawPhoto}
+    };
+    const uint32_t sizes[][2] = {{256, 256}, {1024, 768}, {1920, 1080}};
+    const uint8_t channelCounts[] = {1, 3, 4};
+    size_t sizeCount = quick ? 2 : 3;
+
+    uint64_t seed = 1;
+    for (size_t k = 0; k < 4; k++) {
+        for (size_t s = 0; s < sizeCount; s++) {
+            for (size_t c = 0; c < 3; c++) {
+                CorpusImage image;
+                image.width = sizes[s][0];
+                image.height = sizes[s][1];
+                image.channels = channelCounts[c];
+                image.pixels.resize(static_cast<size_t>(image.width) * image.height * image.channels);
+                std::ostringstream name;
+                name << kinds[k].name << "_" << image.width << "x" << image.height << "x" << (int)image.channels;
+                image.name = name.str();
+                Random random(seed++);
+                kinds[k].draw(image, random);
+                corpus.push_back(image);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Timings of one stage over the whole corpus
+ */
+struct StageStats {
+    std::string name;
+    uint64_t bytesIn;
+    uint64_t bytesOut;
+    std::vector<double> seconds;
+
+    explicit StageStats(const std::string& name) : name(name), bytesIn(0), bytesOut(0) {}
+
+    /**
+     * @brief Times one call of fn, which returns the size of what it produced
+     * @param input Bytes the call consumes
+     */
+    void measure(uint64_t input, const std::function<uint64_t()>& fn) {
+        Clock::time_point start = Clock::now();
+        uint64_t output = fn();
+        seconds.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        bytesIn += input;
+        bytesOut += output;
+    }
+};
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(fraction * values.size()));
+    return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+uint64_t peakRSSKilobytes() {
+#ifdef _WIN32
+    return 0;  // reported as null; the Windows counters need psapi
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+struct Chunk {
+    uint32_t type;
+    size_t offset;
+    uint32_t length;
+};
+
+// The chunk walk readPNG does, without the CRC, which is its own stage.
+void walkChunks(const std::vector<uint8_t>& file, std::vector<Chunk>& chunks) {
+    chunks.clear();
+    size_t pos = 8;
+    while (file.size() - pos >= 12) {
+        Chunk chunk;
+        chunk.length = readBigEndian32(&file[pos]);
+        chunk.type = readBigEndian32(&file[pos + 4]);
+        chunk.offset = pos + 8;
+        if (chunk.length > file.size() - pos - 12) {
+            break;
+        }
+        chunks.push_back(chunk);
+        pos += 12 + static_cast<size_t>(chunk.length);
+    }
+}
+
+// The pixels loadRegion() must return for a rectangle of an image.
+std::vector<uint8_t> cropPixels(const CorpusImage& image, uint32_t x, uint32_t y,
+                                uint32_t width, uint32_t height) {
+    size_t stride = static_cast<size_t>(image.width) * image.channels;
+    size_t rowBytes = static_cast<size_t>(width) * image.channels;
+    std::vector<uint8_t> crop(rowBytes * height);
+    for (uint32_t row = 0; row < height; row++) {
+        std::memcpy(&crop[row * rowBytes], &image.pixels[(y + row) * stride + x * image.channels], rowBytes);
+    }
+    return crop;
+}
+
+struct CodecConfig {
+    const char* name;
+    SametCodec codec;
+    SametEntropy entropy;
+    SametPredictor predictor;
+};
+
+void writeStage(std::ostream& out, const StageStats& stage, bool last) {
+    double total = 0.0;
+    for (size_t i = 0; i < stage.seconds.size(); i++) {
+        total += stage.seconds[i];
+    }
+    out << "    {\"name\": \"" << stage.name << "\", \"calls\": " << stage.seconds.size()
+        << ", \"bytes_in\": " << stage.bytesIn << ", \"bytes_out\": " << stage.bytesOut
+        << std::fixed << std::setprecision(2)
+        << ", \"mb_per_s\": " << (total > 0 ? stage.bytesIn / total / 1e6 : 0.0)
+        << std::setprecision(4)
+        << ", \"ratio\": " << (stage.bytesIn ? static_cast<double>(stage.bytesOut) / stage.bytesIn : 0.0)
+        << ", \"p50_ms\": " << percentile(stage.seconds, 0.50) * 1e3
+        << ", \"p99_ms\": " << percentile(stage.seconds, 0.99) * 1e3
+        << "}" << (last ? "" : ",") << "\n";
+}
+
+void printUsage() {
+    std::cerr << "Usage: image_bench [--quick] [--repeat N] [--output FILE] [--scratch FILE]\n"
+              << "Prints the throughput of every stage as JSON.\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool quick = false;
+    int repeat = 3;
+    std::string outputName;
+    std::string scratchName = "image_bench.tmp";
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--quick") {
+            quick = true;
+        } else if (option == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (option == "--output" && i + 1 < argc) {
+            outputName = argv[++i];
+        } else if (option == "--scratch" && i + 1 < argc) {
+            scratchName = argv[++i];
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    // Base name of the streaming encoder's output, which gets ".samet" appended.
+    std::string streamName = scratchName + ".stream";
+    std::string tiledName = scratchName + ".tiled";
+
+    // The library reports every step on std::cout; keep that out of the JSON.
+    std::streambuf* console = std::cout.rdbuf();
+    NullBuffer discard;
+    std::cout.rdbuf(&discard);
+
+    std::vector<CorpusImage> corpus;
+    buildCorpus(quick, corpus);
+    uint64_t corpusBytes = 0;
+    for (size_t i = 0; i < corpus.size(); i++) {
+        CorpusImage& image = corpus[i];
+        corpusBytes += image.pixels.size();
+        std::ostringstream png;
+        PNGImage encoder;
+        ByteSpan source = {image.pixels.data(), image.pixels.size()};
+        encoder.writePNG(png, source, image.width, image.height, image.channels);
+        std::string bytes = png.str();
+        image.png.assign(bytes.begin(), bytes.end());
+    }
+
+    StageStats filter("png_filter");
+    StageStats deflate("png_deflate");
+    StageStats write("file_write");
+    StageStats read("file_read");
+    StageStats chunkRead("png_chunk_read");
+    StageStats crc("png_crc");
+    StageStats inflate("png_inflate");
+    StageStats unfilter("png_unfilter");
+    StageStats decode("png_decode");
+    StageStats streamEncode("samet_stream_encode");
+    StageStats regionDecode("samet_region_decode");
+
+    const CodecConfig configs[] = {
+        {"raw", SametCodec::RAW, SametEntropy::NONE, SametPredictor::NONE},
+        {"rle", SametCodec::RLE, SametEntropy::NONE, SametPredictor::NONE},
+        {"lz", SametCodec::LZ, SametEntropy::NONE, SametPredictor::NONE},
+        {"lz_huffman", SametCodec::LZ, SametEntropy::HUFFMAN, SametPredictor::NONE},
+        {"rle_rans", SametCodec::RLE, SametEntropy::RANS, SametPredictor::NONE},
+        {"med_lz_rans", SametCodec::LZ, SametEntropy::RANS, SametPredictor::MED}
+    };
+    const size_t configCount = sizeof(configs) / sizeof(configs[0]);
+    std::vector<StageStats> encoders;
+    std::vector<StageStats> decoders;
+    for (size_t c = 0; c < configCount; c++) {
+        encoders.push_back(StageStats(std::string("samet_") + configs[c].name + "_encode"));
+        decoders.push_back(StageStats(std::string("samet_") + configs[c].name + "_decode"));
+    }
+
+    bool correct = true;
+    std::vector<uint8_t> filtered;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> fileBytes;
+    std::vector<Chunk> chunks;
+    std::vector<uint8_t> inflated;
+    std::vector<uint8_t> pixels;
+    for (int r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < corpus.size(); i++) {
+            const CorpusImage& image = corpus[i];
+            size_t stride = static_cast<size_t>(image.width) * image.channels;
+            size_t rawSize = image.pixels.size();
+            size_t filteredSize = (stride + 1) * image.height;
+
+            filter.measure(rawSize, [&]() {
+                filtered.resize(filteredSize);
+                FilterSelector selector;
+                selector.filterImage(image.pixels.data(), stride, image.height, image.channels, filtered.data());
+                return static_cast<uint64_t>(filtered.size());
+            });
+            deflate.measure(filteredSize, [&]() {
+                Deflater deflater;
+                deflater.compress(filtered.data(), filtered.size(), compressed);
+                return static_cast<uint64_t>(compressed.size());
+            });
+
+            write.measure(image.png.size(), [&]() {
+                std::ofstream file(scratchName, std::ios::binary);
+                file.write(reinterpret_cast<const char*>(image.png.data()), image.png.size());
+                file.close();
+                correct = correct && !file.fail();
+                return static_cast<uint64_t>(image.png.size());
+            });
+            read.measure(image.png.size(), [&]() {
+                RandomAccessFile file;
+                fileBytes.resize(image.png.size());
+                correct = file.open(scratchName) && file.size() == fileBytes.size() &&
+                          file.readAt(0, fileBytes.data(), fileBytes.size()) && correct;
+                return static_cast<uint64_t>(fileBytes.size());
+            });
+
+            chunkRead.measure(fileBytes.size(), [&]() {
+                walkChunks(fileBytes, chunks);
+                return static_cast<uint64_t>(fileBytes.size());
+            });
+            crc.measure(fileBytes.size(), [&]() {
+                for (size_t c = 0; c < chunks.size(); c++) {
+                    uint32_t expected = readBigEndian32(&fileBytes[chunks[c].offset + chunks[c].length]);
+                    correct = CRC32::update(0, &fileBytes[chunks[c].offset - 4], chunks[c].length + 4) == expected &&
+                              correct;
+                }
+                return static_cast<uint64_t>(fileBytes.size());
+            });
+
+            uint64_t idatBytes = 0;
+            for (size_t c = 0; c < chunks.size(); c++) {
+                if (chunks[c].type == static_cast<uint32_t>(ChunkType::IDAT)) {
+                    idatBytes += chunks[c].length;
+                }
+            }
+            inflate.measure(idatBytes, [&]() {
+                Inflater inflater;
+                for (size_t c = 0; c < chunks.size(); c++) {
+                    if (chunks[c].type == static_cast<uint32_t>(ChunkType::IDAT)) {
+                        inflater.addInput(&fileBytes[chunks[c].offset], chunks[c].length);
+                    }
+                }
+                inflated.resize(filteredSize);
+                size_t produced = 0;
+                correct = inflater.inflate(inflated.data(), inflated.size(), produced) &&
+                          produced == filteredSize && correct;
+                return static_cast<uint64_t>(produced);
+            });
+            unfilter.measure(filteredSize, [&]() {
+                PNGFilter::UnfilterKernels kernels = PNGFilter::selectUnfilterKernels(image.channels);
+                pixels.resize(rawSize);
+                std::vector<uint8_t> zeroRow(stride, 0);
+                const uint8_t* prior = zeroRow.data();
+                for (uint32_t y = 0; y < image.height; y++) {
+                    uint8_t* row = pixels.data() + y * stride;
+                    std::memcpy(row, inflated.data() + y * (stride + 1) + 1, stride);
+                    correct = PNGFilter::unfilterRow(kernels, inflated[y * (stride + 1)], row, prior, stride) &&
+                              correct;
+                    prior = row;
+                }
+                return static_cast<uint64_t>(rawSize);
+            });
+            correct = correct && pixels == image.pixels;
+
+            decode.measure(fileBytes.size(), [&]() {
+                PNGImage decoded;
+                ByteSpan bytes = {fileBytes.data(), fileBytes.size()};
+                correct = decoded.decodePNG(bytes) && decoded.getData() == image.pixels && correct;
+                return static_cast<uint64_t>(decoded.getData().size());
+            });
+
+            for (size_t c = 0; c < configCount; c++) {
+                ImageCompressor compressor;
+                compressor.setCodec(configs[c].codec);
+                compressor.setEntropy(configs[c].entropy);
+                compressor.setPredictor(configs[c].predictor);
+                std::stringstream encoded;
+                ByteSpan source = {image.pixels.data(), image.pixels.size()};
+                encoders[c].measure(rawSize, [&]() {
+                    correct = compressor.writeCompressed(source, image.width, image.height,
+                                                         image.channels, 8, encoded) && correct;
+                    // The header is written last, at the start; measure the whole stream.
+                    encoded.seekp(0, std::ios::end);
+                    return static_cast<uint64_t>(encoded.tellp());
+                });
+                std::string container = encoded.str();
+                decoders[c].measure(container.size(), [&]() {
+                    PNGImage decoded;
+                    ByteSpan bytes = {reinterpret_cast<const uint8_t*>(container.data()), container.size()};
+                    correct = compressor.loadCompressed(bytes, decoded) &&
+                              decoded.getData() == image.pixels && correct;
+                    return static_cast<uint64_t>(decoded.getData().size());
+                });
+            }
+
+            // The streaming encoder reads the PNG from the scratch file row by
+            // row; its output must match the in-memory encoder byte for byte.
+            ImageCompressor streamer;
+            std::stringstream reference;
+            ByteSpan source = {image.pixels.data(), image.pixels.size()};
+            correct = streamer.writeCompressed(source, image.width, image.height, image.channels, 8, reference) &&
+                      correct;
+            streamEncode.measure(fileBytes.size(), [&]() {
+                PNGRowReader reader;
+                correct = reader.open(scratchName) && streamer.saveCompressed(reader, streamName) && correct;
+                std::ifstream written(streamName + ".samet", std::ios::binary | std::ios::ate);
+                return static_cast<uint64_t>(std::max<std::streamoff>(written.tellg(), 0));
+            });
+            std::ifstream streamed(streamName + ".samet", std::ios::binary);
+            std::string streamedBytes((std::istreambuf_iterator<char>(streamed)), std::istreambuf_iterator<char>());
+            correct = correct && streamedBytes == reference.str();
+
+            // A rectangle that straddles tile edges, read from a tiled copy and
+            // from the linear streamed file, must equal the same crop of the image.
+            ImageCompressor tiler;
+            tiler.setTileSize(64);
+            SametHeader info;
+            correct = tiler.saveCompressed(source, image.width, image.height, image.channels, 8, tiledName) &&
+                      tiler.readInfo(tiledName + ".samet", info) && info.width == image.width &&
+                      info.height == image.height && info.channels == image.channels && info.tileSize == 64 &&
+                      correct;
+            uint32_t regionX = image.width / 4 + 7;
+            uint32_t regionY = image.height / 4 + 5;
+            uint32_t regionWidth = image.width / 2;
+            uint32_t regionHeight = image.height / 2;
+            std::vector<uint8_t> crop = cropPixels(image, regionX, regionY, regionWidth, regionHeight);
+            regionDecode.measure(crop.size(), [&]() {
+                PNGImage region;
+                correct = tiler.loadRegion(tiledName + ".samet", regionX, regionY, regionWidth, regionHeight,
+                                           region) &&
+                          region.getData() == crop && correct;
+                return static_cast<uint64_t>(region.getData().size());
+            });
+            PNGImage linearRegion;
+            correct = streamer.loadRegion(streamName + ".samet", regionX, regionY, regionWidth, regionHeight,
+                                          linearRegion) &&
+                      linearRegion.getData() == crop && correct;
+        }
+    }
+    std::remove(scratchName.c_str());
+    std::remove((streamName + ".samet").c_str());
+    std::remove((tiledName + ".samet").c_str());
+    std::cout.rdbuf(console);
+
+    std::ofstream outputFile;
+    if (!outputName.empty()) {
+        outputFile.open(outputName);
+        if (!outputFile) {
+            std::cerr << "Error: Cannot create " << outputName << std::endl;
+            return 2;
+        }
+    }
+    std::ostream& out = outputName.empty() ? std::cout : outputFile;
+
+    std::vector<const StageStats*> stages = {&filter, &deflate, &write, &read, &chunkRead,
+                                             &crc, &inflate, &unfilter, &decode, &streamEncode,
+                                             &regionDecode};
+    for (size_t c = 0; c < configCount; c++) {
+        stages.push_back(&encoders[c]);
+        stages.push_back(&decoders[c]);
+    }
+
+    uint64_t rss = peakRSSKilobytes();
+    out << "{\n"
+        << "  \"benchmark\": \"image_compressor\",\n"
+        << "  \"version\": 1,\n"
+        << "  \"quick\": " << (quick ? "true" : "false") << ",\n"
+        << "  \"repeat\": " << repeat << ",\n"
+        << "  \"threads\": " << ThreadPool::shared().getThreadCount() << ",\n"
+        << "  \"corpus\": {\"images\": " << corpus.size() << ", \"bytes\": " << corpusBytes << "},\n"
+        << "  \"round_trip_ok\": " << (correct ? "true" : "false") << ",\n"
+        << "  \"peak_rss_kb\": ";
+    if (rss != 0) {
+        out << rss;
+    } else {
+        out << "null";
+    }
+    out << ",\n  \"stages\": [\n";
+    for (size_t i = 0; i < stages.size(); i++) {
+        writeStage(out, *stages[i], i + 1 == stages.size());
+    }
+    out << "  ]\n}\n";
+
+    if (!correct) {
+        std::cerr << "Error: A stage produced wrong output" << std::endl;
+        return 1;
+    }
+    return 0;
+}
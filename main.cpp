@@ -2,8 +2,21 @@
 #include <fstream>
 #include <limits>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <set>
+#include <streambuf>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <glob.h>
+#endif
 #include "PNGImage.h"
 #include "ImageCompressor.h"
+#include "BatchProcessor.h"
+#include "Stats.h"
 
 /**
  * @file main.cpp
@@ -23,7 +36,341 @@ void displayMenu() {
     std::cout << "Enter your choice (1-3): ";
 }
 
-int main() {
+/**
+ * @brief Stream buffer that discards everything written to it
+ *
+ * Batch runs swap it in for the buffer of std::cout so the per-step messages
+ * of the library stay out of the per-file summary.
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+/**
+ * @brief Prints the command line usage
+ */
+void printUsage(std::ostream& out) {
+    out << "Usage: image_compressor                                  (interactive menu)\n"
+        << "       image_compressor compress|decompress [options] inputs...\n"
+        << "\n"
+        << "Inputs are files, directories (every .png or .samet file inside), glob\n"
+        << "patterns, or - to read one path per line from standard input.\n"
+        << "\n"
+        << "Options:\n"
+        << "  --jobs N         Files decoded and encoded at the same time (default: half the cores)\n"
+        << "  --out DIR        Write outputs into DIR instead of next to the inputs\n"
+        << "  --codec C        raw, rle or lz (compress, default rle)\n"
+        << "  --entropy E      none, huffman or rans (compress, default none)\n"
+        << "  --predictor P    none, left, up, average or med (compress, default none)\n"
+        << "  --policy P       fixed, ratio, speed or budget (compress, default fixed)\n"
+        << "  --tile N         Store N x N tiles instead of linear blocks (compress)\n"
+        << "  --level N        PNG deflate level 0-9 (decompress, default 6)\n"
+        << "  --stats FILE     Write per-stage timings and counters to FILE (.prom for\n"
+        << "                   Prometheus text format, JSON otherwise)\n"
+        << "  --verbose        Keep the step-by-step messages of every file\n"
+        << "\n"
+        << "Exit status: 0 if every file was converted, 1 if any failed, 2 on usage errors.\n";
+}
+
+/**
+ * @brief Parses a whole decimal number within [low, high]
+ * @return true if text is such a number
+ */
+bool parseNumber(const char* text, unsigned long low, unsigned long high, unsigned long& value) {
+    char* end = nullptr;
+    value = std::strtoul(text, &end, 10);
+    return *text != '\0' && *end == '\0' && text[0] != '-' && value >= low && value <= high;
+}
+
+/**
+ * @brief Returns true if name ends with suffix
+ */
+bool endsWith(const std::string& name, const std::string& suffix) {
+    return name.length() >= suffix.length() &&
+           name.compare(name.length() - suffix.length(), suffix.length(), suffix) == 0;
+}
+
+/**
+ * @brief Appends the files matching a wildcard pattern, in sorted order
+ */
+void expandPattern(const std::string& pattern, std::vector<std::string>& files) {
+    std::vector<std::string> matches;
+#ifdef _WIN32
+    std::string directory;
+    size_t slash = pattern.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        directory = pattern.substr(0, slash + 1);
+    }
+    WIN32_FIND_DATAA found;
+    HANDLE handle = FindFirstFileA(pattern.c_str(), &found);
+    if (handle != INVALID_HANDLE_VALUE) {
+        do {
+            if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                matches.push_back(directory + found.cFileName);
+            }
+        } while (FindNextFileA(handle, &found));
+        FindClose(handle);
+    }
+#else
+    glob_t result;
+    if (glob(pattern.c_str(), 0, nullptr, &result) == 0) {
+        for (size_t i = 0; i < result.gl_pathc; i++) {
+            matches.push_back(result.gl_pathv[i]);
+        }
+    }
+    globfree(&result);
+#endif
+    std::sort(matches.begin(), matches.end());
+    files.insert(files.end(), matches.begin(), matches.end());
+}
+
+/**
+ * @brief Turns the input arguments into a list of files
+ * @param arguments Files, directories, glob patterns or - for standard input
+ * @param extension Extension of the files taken from directories
+ * @param files Receives the file paths
+ * @return true if every argument named at least one file, false otherwise
+ */
+bool collectInputs(const std::vector<std::string>& arguments, const std::string& extension,
+                   std::vector<std::string>& files) {
+    bool ok = true;
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const std::string& argument = arguments[i];
+        if (argument == "-") {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (!line.empty()) {
+                    files.push_back(line);
+                }
+            }
+            continue;
+        }
+
+        struct stat info;
+        size_t before = files.size();
+        if (stat(argument.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR) {
+            expandPattern(argument + "/*" + extension, files);
+        } else if (argument.find_first_of("*?[") != std::string::npos) {
+            expandPattern(argument, files);
+        } else {
+            files.push_back(argument);
+            continue;
+        }
+        if (files.size() == before) {
+            std::cerr << "Error: No files match " << argument << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Derives the output path of one input
+ *
+ * Without an output directory the file lands next to its input, named as the
+ * interactive menu names it.
+ */
+std::string outputPath(const std::string& input, bool compress, const std::string& outDir) {
+    std::string stem = input;
+    if (compress && endsWith(stem, ".png")) {
+        stem.erase(stem.length() - 4);
+    } else if (!compress && endsWith(stem, ".samet")) {
+        stem.erase(stem.length() - 6);
+    }
+
+    if (outDir.empty()) {
+        return stem + (compress ? ".samet" : "_decompressed.png");
+    }
+    size_t slash = stem.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        stem.erase(0, slash + 1);
+    }
+    std::string separator = endsWith(outDir, "/") || endsWith(outDir, "\\") ? "" : "/";
+    return outDir + separator + stem + (compress ? ".samet" : ".png");
+}
+
+/**
+ * @brief Runs a non-interactive batch conversion
+ * @return Process exit status
+ */
+int runBatch(int argc, char* argv[]) {
+    std::string command = argv[1];
+    if (command == "-h" || command == "--help") {
+        printUsage(std::cout);
+        return 0;
+    }
+    if (command != "compress" && command != "decompress") {
+        std::cerr << "Error: Unknown command '" << command << "'\n\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+    bool compress = command == "compress";
+
+    ImageCompressor compressor;
+    size_t jobs = 0;
+    int level = 6;
+    std::string outDir;
+    std::string statsFile;
+    bool verbose = false;
+    std::vector<std::string> arguments;
+
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        unsigned long number = 0;
+        bool takesValue = option == "--jobs" || option == "--out" || option == "--codec" ||
+                          option == "--entropy" || option == "--predictor" || option == "--policy" ||
+                          option == "--tile" || option == "--level" || option == "--stats";
+        if (takesValue && i + 1 >= argc) {
+            std::cerr << "Error: " << option << " needs a value" << std::endl;
+            return 2;
+        }
+
+        bool valid = true;
+        if (option == "--jobs") {
+            valid = parseNumber(value.c_str(), 1, 1024, number);
+            jobs = number;
+        } else if (option == "--out") {
+            outDir = value;
+        } else if (option == "--codec") {
+            valid = value == "raw" || value == "rle" || value == "lz";
+            compressor.setCodec(value == "raw" ? SametCodec::RAW : value == "lz" ? SametCodec::LZ : SametCodec::RLE);
+        } else if (option == "--entropy") {
+            valid = value == "none" || value == "huffman" || value == "rans";
+            compressor.setEntropy(value == "huffman" ? SametEntropy::HUFFMAN :
+                                  value == "rans" ? SametEntropy::RANS : SametEntropy::NONE);
+        } else if (option == "--predictor") {
+            valid = value == "none" || value == "left" || value == "up" || value == "average" || value == "med";
+            compressor.setPredictor(value == "left" ? SametPredictor::LEFT :
+                                    value == "up" ? SametPredictor::UP :
+                                    value == "average" ? SametPredictor::AVERAGE :
+                                    value == "med" ? SametPredictor::MED : SametPredictor::NONE);
+        } else if (option == "--policy") {
+            valid = value == "fixed" || value == "ratio" || value == "speed" || value == "budget";
+            compressor.setCodecPolicy(value == "ratio" ? CodecPolicy::MAX_RATIO :
+                                      value == "speed" ? CodecPolicy::MAX_SPEED :
+                                      value == "budget" ? CodecPolicy::BUDGET : CodecPolicy::FIXED);
+        } else if (option == "--tile") {
+            valid = parseNumber(value.c_str(), 0, UINT16_MAX, number);
+            compressor.setTileSize(static_cast<uint16_t>(number));
+        } else if (option == "--level") {
+            valid = parseNumber(value.c_str(), 0, 9, number);
+            level = static_cast<int>(number);
+        } else if (option == "--stats") {
+            statsFile = value;
+        } else if (option == "--verbose") {
+            verbose = true;
+        } else if (option.length() > 2 && option.compare(0, 2, "--") == 0) {
+            std::cerr << "Error: Unknown option " << option << std::endl;
+            return 2;
+        } else {
+            arguments.push_back(option);
+        }
+
+        if (!valid) {
+            std::cerr << "Error: Invalid value '" << value << "' for " << option << std::endl;
+            return 2;
+        }
+        if (takesValue) {
+            i++;
+        }
+    }
+
+    std::vector<std::string> inputs;
+    if (arguments.empty()) {
+        std::cerr << "Error: No input files given\n\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+    if (!collectInputs(arguments, compress ? ".png" : ".samet", inputs)) {
+        return 2;
+    }
+    if (inputs.empty()) {
+        std::cerr << "Error: No input files given" << std::endl;
+        return 2;
+    }
+
+    if (!outDir.empty()) {
+        struct stat info;
+        if (stat(outDir.c_str(), &info) != 0 || (info.st_mode & S_IFMT) != S_IFDIR) {
+            std::cerr << "Error: Output directory " << outDir << " does not exist" << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<std::string> outputs;
+    std::set<std::string> taken;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        outputs.push_back(outputPath(inputs[i], compress, outDir));
+        if (!taken.insert(outputs.back()).second) {
+            std::cerr << "Error: More than one input would be written to " << outputs.back() << std::endl;
+            return 2;
+        }
+    }
+
+    BatchProcessor processor(compressor);
+    processor.setPNGCompressionLevel(level);
+    if (jobs != 0) {
+        processor.setReaderThreads(jobs);
+        processor.setDecoderThreads(jobs);
+        processor.setEncoderThreads(jobs);
+        processor.setDepth(2 * jobs + 2);
+    }
+
+    // The summary goes to the real standard output; the messages the library
+    // prints along the way are dropped unless asked for.
+    std::ostream summary(std::cout.rdbuf());
+    NullBuffer discard;
+    if (!verbose) {
+        std::cout.rdbuf(&discard);
+    }
+
+    size_t failed = 0;
+    uint64_t totalIn = 0;
+    uint64_t totalOut = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    processor.run(compress ? BatchMode::COMPRESS : BatchMode::DECOMPRESS, inputs, outputs,
+                  [&](const BatchResult& result) {
+        if (!result.ok) {
+            failed++;
+            summary << "FAILED  " << result.input << "  " << result.error << std::endl;
+            return;
+        }
+        totalIn += result.inputBytes;
+        totalOut += result.outputBytes;
+        summary << "ok      " << result.input << " -> " << result.output << "  "
+                << result.inputBytes << " -> " << result.outputBytes << " bytes ("
+                << std::fixed << std::setprecision(2)
+                << (result.inputBytes ? 100.0 * result.outputBytes / result.inputBytes : 0.0) << "%), "
+                << std::setprecision(3) << result.seconds << " s" << std::endl;
+    });
+    double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout.rdbuf(summary.rdbuf());
+
+    summary << inputs.size() << " files, " << failed << " failed, " << totalIn << " -> " << totalOut
+            << " bytes in " << std::fixed << std::setprecision(3) << totalSeconds << " s";
+    if (totalSeconds > 0) {
+        summary << " (" << std::setprecision(1) << totalIn / totalSeconds / 1e6 << " MB/s)";
+    }
+    summary << std::endl;
+
+    if (!statsFile.empty() && !Stats::save(statsFile)) {
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return runBatch(argc, argv);
+    }
+
     PNGImage image;
     std::string input;
     bool running = true;